@@ -0,0 +1,23 @@
+#pragma once
+
+namespace MarCbench
+{
+	const char* HelpText =
+		"Options:\n"
+		"    --help            View this help page.\n"
+		"    --verbose         Print the result of every single run.\n"
+		"  Workloads:\n"
+		"    -n [count]        Number of timed runs per workload. (Default: 5)\n"
+		"    -w [directory]    Directory containing the workload files. (Default: MarCbench/workloads)\n"
+		"    -m [directory]    Directory to search for modules in (Can be used multiple times).\n"
+		"    -e [directory]    Directory to search for extensions in (Can be used multiple times).\n"
+		"    --aligned         Assemble the workloads with the aligned code encoding.\n"
+		"    --compact         Assemble the workloads with the compact code encoding.\n"
+		"    --unchecked       Verify the workloads and interpret them without runtime checks.\n"
+		"    [name]            Only run the workload with the given name (Can be used multiple times).\n"
+		"  Reporting:\n"
+		"    -o [filepath]     Write the results as JSON to the given file.\n"
+		"    -b [filepath]     Compare the results against a baseline JSON file written with '-o'.\n"
+		"    -t [tolerance]    Relative tolerance for the baseline comparison. (Default: 0.10)\n"
+		;
+}
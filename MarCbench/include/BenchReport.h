@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "errors/MarCoreError.h"
+
+namespace MarCbench
+{
+	struct WorkloadResult
+	{
+		std::string name;
+		uint64_t nInstructions = 0;
+		uint64_t codeBytes = 0; // Size of the linked code memory
+		double wallMinUs = 0.0;
+		double wallMedianUs = 0.0;
+		double wallMeanUs = 0.0;
+		double insPerSec = 0.0;
+		uint64_t peakRssKb = 0;
+		uint64_t guestAllocs = 0;
+		uint64_t guestFrees = 0;
+		uint64_t hostAllocs = 0; // Host allocations of a single (timed) run
+	};
+
+	struct BenchReport
+	{
+		uint64_t nRuns = 0;
+		std::vector<WorkloadResult> workloads;
+	public:
+		const WorkloadResult* find(const std::string& name) const;
+	public:
+		void writeJson(std::ostream& oStream) const;
+		void writeTable(std::ostream& oStream) const;
+	public:
+		static BenchReport loadJson(const std::string& filepath);
+	};
+
+	// Compares 'current' against 'baseline' and prints every deviation to 'oStream'.
+	// Returns the number of regressions exceeding the given tolerance.
+	uint64_t compareReports(const BenchReport& baseline, const BenchReport& current, double tolerance, std::ostream& oStream);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <set>
+#include <string>
+
+#include "types/BytecodeTypes.h"
+
+namespace MarCbench
+{
+	struct Settings
+	{
+		std::string exeDir = "";
+		std::string workloadDir = "";
+		std::string outFile = "";
+		std::string baselineFile = "";
+		std::set<std::string> modDirs;
+		std::set<std::string> extDirs;
+		std::set<std::string> workloadFilter; // Empty -> run all workloads
+		uint64_t nRuns = 5;
+		double tolerance = 0.10; // Relative deviation from the baseline considered a regression
+		MarC::BC_CodeEncoding codeEncoding = MarC::BC_CodeEncoding::Packed;
+		bool unchecked = false; // Verify the workloads and interpret them without runtime checks
+		bool verbose = false;
+	};
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace MarCbench
+{
+	class Timer
+	{
+	public:
+		void start() { m_start = std::chrono::steady_clock::now(); }
+		void stop() { m_stop = std::chrono::steady_clock::now(); }
+		uint64_t nanoseconds() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(m_stop - m_start).count(); }
+		double microseconds() const { return nanoseconds() / 1000.0; }
+	private:
+		std::chrono::time_point<std::chrono::steady_clock> m_start;
+		std::chrono::time_point<std::chrono::steady_clock> m_stop;
+	};
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+
+#if defined MARCBENCH_PLATFORM_WINDOWS
+#define NOMINMAX
+#include <Windows.h>
+#elif defined MARCBENCH_PLATFORM_UNIX
+#include <unistd.h>
+#endif
+
+namespace MarCbench
+{
+	#if defined MARCBENCH_PLATFORM_WINDOWS
+
+	inline std::string CurrExePath()
+	{
+		char buff[1024];
+		uint64_t count = GetModuleFileName(NULL, buff, sizeof(buff));
+		return std::string(buff, count);
+	}
+
+	#elif defined MARCBENCH_PLATFORM_UNIX
+
+	inline std::string CurrExePath()
+	{
+		char buff[1024];
+		auto count = readlink("/proc/self/exe", buff, sizeof(buff));
+		return std::string(buff, count < 0 ? 0 : count);
+	}
+
+	#endif
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "errors/MarCoreError.h"
+
+namespace MarCbench
+{
+	// Minimal JSON document model, just enough to read back the reports written by MarCbench.
+	struct JsonValue
+	{
+		enum class Type
+		{
+			Null,
+			Bool,
+			Number,
+			String,
+			Array,
+			Object,
+		} type = Type::Null;
+		bool boolean = false;
+		double number = 0.0;
+		std::string string;
+		std::vector<JsonValue> array;
+		std::map<std::string, JsonValue> object;
+	public:
+		const JsonValue* find(const std::string& key) const;
+		double getNumber(const std::string& key, double defVal = 0.0) const;
+		std::string getString(const std::string& key) const;
+	public:
+		static JsonValue parse(const std::string& text);
+	};
+
+	void writeJsonString(std::ostream& oStream, const std::string& str);
+}
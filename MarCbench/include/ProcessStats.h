@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+namespace MarCbench
+{
+	// Resets the peak resident set size of the process (if supported by the platform).
+	void resetPeakRss();
+	// Returns the peak resident set size of the process in KiB.
+	uint64_t peakRssKb();
+	// Returns the number of calls to the global operator new since the process started.
+	uint64_t hostAllocCount();
+}
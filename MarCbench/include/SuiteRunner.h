@@ -0,0 +1,16 @@
+#pragma once
+
+#include "BenchSettings.h"
+#include "BenchReport.h"
+#include "Workloads.h"
+
+namespace MarCbench
+{
+	class SuiteRunner
+	{
+	public:
+		static int run(const Settings& settings);
+	private:
+		static WorkloadResult runWorkload(const Settings& settings, const Workload& workload);
+	};
+}
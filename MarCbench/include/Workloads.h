@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+namespace MarCbench
+{
+	struct Workload
+	{
+		const char* name;
+		int64_t expectedExitCode;
+		bool sinkOutput; // Redirect std::cout while the workload is running
+	};
+
+	// Every workload is stored as '<name>.mca' in the workload directory.
+	// A run is only valid if the interpreter reaches the end of code with the expected exit code.
+	static const Workload Workloads[] = {
+		{ "fibonacci",            317811,              false },
+		{ "fibonacciNoRecursion", 7540113804746346429, false },
+		{ "gameOfLife",           0,                   true  },
+		{ "arraySort",            512,                 false },
+		{ "heapChurn",            200010000,           false },
+		{ "stringCopy",           55,                  false },
+	};
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace MarCbench
+{
+	const char* AsmHelpText =
+		"Measures the throughput of the tokenizer, assembler and linker on generated modules.\n"
+		"Options:\n"
+		"    --help            View this help page.\n"
+		"    -s [sizes]        Comma separated list of module sizes in instructions. (Default: 10000,100000)\n"
+		"    -y [ratio]        One static symbol per [ratio] instructions. (Default: 10)\n"
+		"    -d [depth]        Depth of the nested macro chain. (Default: 16)\n"
+		"    -n [count]        Runs per module size, the fastest run of each phase is reported. (Default: 1)\n"
+		"    -o [directory]    Write the generated modules to the given directory.\n"
+		;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "asm/AsmSettings.h"
+#include "asm/ModuleGenerator.h"
+
+namespace MarCbench
+{
+	struct AsmPhaseTimes
+	{
+		double tokenizeNs = 0.0;
+		double assembleNs = 0.0;
+		double linkNs = 0.0;
+	};
+
+	class AsmRunner
+	{
+	public:
+		static int run(const AsmSettings& settings);
+	private:
+		static AsmPhaseTimes measure(const GeneratedModule& mod);
+	};
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace MarCbench
+{
+	struct AsmSettings
+	{
+		std::vector<uint64_t> sizes = { 10000, 100000 }; // Number of instructions per generated module
+		uint64_t symbolRatio = 10; // One static symbol per 'symbolRatio' instructions
+		uint64_t macroDepth = 16;
+		uint64_t nRuns = 1;
+		std::string dumpDir = ""; // Write the generated modules to this directory
+	};
+}
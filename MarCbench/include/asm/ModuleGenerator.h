@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+namespace MarCbench
+{
+	struct GeneratedModule
+	{
+		std::string source;
+		uint64_t nInstructions = 0; // Instructions after macro expansion
+		uint64_t nSymbols = 0;
+	};
+
+	// Generates a self contained module (no '#reqmod') with roughly 'nInstructions' instructions.
+	// The module contains 'nInstructions / symbolRatio' static variables, functions that get called
+	// before their definition (unresolved symbols for the linker), labels and a chain of 'macroDepth' nested macros.
+	GeneratedModule generateModule(uint64_t nInstructions, uint64_t symbolRatio, uint64_t macroDepth);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "types/BytecodeTypes.h"
+
+namespace MarCbench
+{
+	// A single cell of the opcode matrix.
+	// 'body' is the MarCembly code of one repetition, it executes 'nInstructions' instructions.
+	struct OpcodeCase
+	{
+		MarC::BC_OpCode opCode;
+		MarC::BC_Datatype datatype;
+		std::string operands; // Deref pattern of the operands, e.g. "A,@@P"
+		std::string body;
+		uint64_t nInstructions;
+	public:
+		std::string rowName() const;
+	};
+
+	// Generates all measured BC_OpCode x BC_Datatype x deref-count combinations.
+	// Instructions with side effects outside of the interpreter (calx, exit) are not part of the matrix.
+	std::vector<OpcodeCase> generateOpcodeCases();
+
+	// Generates the module measuring 'opCase' with the body unrolled 'nUnroll' times inside a loop of 'nIterations'.
+	// With 'opCase' == nullptr only the loop overhead gets measured.
+	std::string generateOpcodeModule(const OpcodeCase* opCase, uint64_t nUnroll, uint64_t nIterations);
+}
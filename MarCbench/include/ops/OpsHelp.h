@@ -0,0 +1,16 @@
+#pragma once
+
+namespace MarCbench
+{
+	const char* OpsHelpText =
+		"Measures the cost of every opcode/datatype/deref combination in the interpreter dispatch loop.\n"
+		"Options:\n"
+		"    --help            View this help page.\n"
+		"    -i [count]        Loop iterations per combination. (Default: 20000)\n"
+		"    -u [count]        Unrolled repetitions per loop iteration. (Default: 32)\n"
+		"    -n [count]        Runs per combination, the fastest run is reported. (Default: 3)\n"
+		"    -s [count]        Number of entries in the 'slowest combinations' list. (Default: 15)\n"
+		"    -o [filepath]     Write all results as CSV to the given file.\n"
+		"    [mnemonic]        Only measure the given instruction, e.g. 'mov' (Can be used multiple times).\n"
+		;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "ops/OpsSettings.h"
+#include "ops/OpcodeCases.h"
+
+namespace MarCbench
+{
+	class OpsRunner
+	{
+	public:
+		static int run(const OpsSettings& settings);
+	private:
+		// Returns the best wall time of 'settings.nRuns' runs of the module in nanoseconds.
+		static double measureModule(const OpsSettings& settings, const std::string& source, uint64_t& nInsExecuted);
+	};
+}
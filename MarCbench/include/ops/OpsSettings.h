@@ -0,0 +1,17 @@
+#pragma once
+
+#include <set>
+#include <string>
+
+namespace MarCbench
+{
+	struct OpsSettings
+	{
+		std::set<std::string> opFilter; // Mnemonics to measure, empty -> all
+		std::string outFile = "";
+		uint64_t nIterations = 20000;
+		uint64_t nUnroll = 32;
+		uint64_t nRuns = 3;
+		uint64_t nSlowest = 15;
+	};
+}
@@ -0,0 +1,167 @@
+#include "BenchReport.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "JsonValue.h"
+
+namespace MarCbench
+{
+	const WorkloadResult* BenchReport::find(const std::string& name) const
+	{
+		for (auto& result : workloads)
+			if (result.name == name)
+				return &result;
+		return nullptr;
+	}
+
+	void BenchReport::writeJson(std::ostream& oStream) const
+	{
+		oStream << "{" << std::endl;
+		oStream << "\t\"version\": 1," << std::endl;
+		oStream << "\t\"runs\": " << nRuns << "," << std::endl;
+		oStream << "\t\"workloads\": [" << std::endl;
+		for (uint64_t i = 0; i < workloads.size(); ++i)
+		{
+			auto& result = workloads[i];
+			oStream << "\t\t{ \"name\": ";
+			writeJsonString(oStream, result.name);
+			oStream << std::fixed << std::setprecision(3)
+				<< ", \"instructions\": " << result.nInstructions
+				<< ", \"codeBytes\": " << result.codeBytes
+				<< ", \"wallMinUs\": " << result.wallMinUs
+				<< ", \"wallMedianUs\": " << result.wallMedianUs
+				<< ", \"wallMeanUs\": " << result.wallMeanUs
+				<< ", \"insPerSec\": " << std::setprecision(0) << result.insPerSec
+				<< ", \"peakRssKb\": " << result.peakRssKb
+				<< ", \"guestAllocs\": " << result.guestAllocs
+				<< ", \"guestFrees\": " << result.guestFrees
+				<< ", \"hostAllocs\": " << result.hostAllocs
+				<< " }" << (i + 1 < workloads.size() ? "," : "") << std::endl;
+		}
+		oStream << "\t]" << std::endl;
+		oStream << "}" << std::endl;
+	}
+
+	void BenchReport::writeTable(std::ostream& oStream) const
+	{
+		oStream << std::left << std::setw(22) << "Workload"
+			<< std::right << std::setw(12) << "Ins"
+			<< std::setw(10) << "Code[B]"
+			<< std::setw(12) << "Median[us]"
+			<< std::setw(12) << "Min[us]"
+			<< std::setw(10) << "MIns/s"
+			<< std::setw(12) << "PeakRSS[KB]"
+			<< std::setw(14) << "Guest a/f"
+			<< std::setw(12) << "HostAllocs" << std::endl;
+
+		for (auto& result : workloads)
+		{
+			std::string guestAllocs = std::to_string(result.guestAllocs) + "/" + std::to_string(result.guestFrees);
+			oStream << std::left << std::setw(22) << result.name
+				<< std::right << std::setw(12) << result.nInstructions
+				<< std::setw(10) << result.codeBytes
+				<< std::fixed << std::setprecision(1)
+				<< std::setw(12) << result.wallMedianUs
+				<< std::setw(12) << result.wallMinUs
+				<< std::setw(10) << result.insPerSec / 1e6
+				<< std::setw(12) << result.peakRssKb
+				<< std::setw(14) << guestAllocs
+				<< std::setw(12) << result.hostAllocs << std::endl;
+		}
+	}
+
+	BenchReport BenchReport::loadJson(const std::string& filepath)
+	{
+		std::ifstream file(filepath);
+		if (!file.is_open())
+			throw MarC::MarCoreError("FileError", "Unable to open baseline file '" + filepath + "'!");
+
+		std::stringstream ss;
+		ss << file.rdbuf();
+
+		JsonValue doc = JsonValue::parse(ss.str());
+		if (doc.type != JsonValue::Type::Object || doc.getNumber("version") != 1)
+			throw MarC::MarCoreError("FileFormatError", "Unsupported baseline file format!");
+
+		BenchReport report;
+		report.nRuns = (uint64_t)doc.getNumber("runs");
+
+		auto workloads = doc.find("workloads");
+		if (!workloads || workloads->type != JsonValue::Type::Array)
+			return report;
+
+		for (auto& entry : workloads->array)
+		{
+			WorkloadResult result;
+			result.name = entry.getString("name");
+			result.nInstructions = (uint64_t)entry.getNumber("instructions");
+			result.codeBytes = (uint64_t)entry.getNumber("codeBytes");
+			result.wallMinUs = entry.getNumber("wallMinUs");
+			result.wallMedianUs = entry.getNumber("wallMedianUs");
+			result.wallMeanUs = entry.getNumber("wallMeanUs");
+			result.insPerSec = entry.getNumber("insPerSec");
+			result.peakRssKb = (uint64_t)entry.getNumber("peakRssKb");
+			result.guestAllocs = (uint64_t)entry.getNumber("guestAllocs");
+			result.guestFrees = (uint64_t)entry.getNumber("guestFrees");
+			result.hostAllocs = (uint64_t)entry.getNumber("hostAllocs");
+			report.workloads.push_back(result);
+		}
+
+		return report;
+	}
+
+	static void reportRegression(const std::string& workload, const char* metric, double baseVal, double currVal, std::ostream& oStream)
+	{
+		oStream << "  REGRESSION " << workload << ": " << metric << " " << baseVal << " -> " << currVal;
+		if (baseVal > 0.0)
+			oStream << " (" << std::showpos << (currVal / baseVal - 1.0) * 100.0 << std::noshowpos << "%)";
+		oStream << std::endl;
+	}
+
+	static bool checkHigherIsWorse(const std::string& workload, const char* metric, double baseVal, double currVal, double tolerance, std::ostream& oStream)
+	{
+		if (currVal <= baseVal * (1.0 + tolerance))
+			return false;
+		reportRegression(workload, metric, baseVal, currVal, oStream);
+		return true;
+	}
+
+	static bool checkLowerIsWorse(const std::string& workload, const char* metric, double baseVal, double currVal, double tolerance, std::ostream& oStream)
+	{
+		if (currVal >= baseVal * (1.0 - tolerance))
+			return false;
+		reportRegression(workload, metric, baseVal, currVal, oStream);
+		return true;
+	}
+
+	uint64_t compareReports(const BenchReport& baseline, const BenchReport& current, double tolerance, std::ostream& oStream)
+	{
+		uint64_t nRegressions = 0;
+
+		oStream << std::fixed << std::setprecision(1);
+
+		for (auto& curr : current.workloads)
+		{
+			auto base = baseline.find(curr.name);
+			if (!base)
+			{
+				oStream << "  NOTE " << curr.name << ": Not present in the baseline." << std::endl;
+				continue;
+			}
+
+			// A different instruction count means the workload or the code generation changed,
+			// the timings are still compared, but this should be kept in mind.
+			if (curr.nInstructions != base->nInstructions)
+				oStream << "  NOTE " << curr.name << ": Instruction count changed " << base->nInstructions << " -> " << curr.nInstructions << std::endl;
+
+			nRegressions += checkHigherIsWorse(curr.name, "wallMedianUs", base->wallMedianUs, curr.wallMedianUs, tolerance, oStream);
+			nRegressions += checkLowerIsWorse(curr.name, "insPerSec", base->insPerSec, curr.insPerSec, tolerance, oStream);
+			nRegressions += checkHigherIsWorse(curr.name, "peakRssKb", (double)base->peakRssKb, (double)curr.peakRssKb, tolerance, oStream);
+			nRegressions += checkHigherIsWorse(curr.name, "hostAllocs", (double)base->hostAllocs, (double)curr.hostAllocs, tolerance, oStream);
+		}
+
+		return nRegressions;
+	}
+}
@@ -0,0 +1,94 @@
+#include <filesystem>
+#include <iostream>
+
+#include <MarCore.h>
+
+#include "BenchHelp.h"
+#include "BenchSettings.h"
+#include "CurrExePath.h"
+#include "SuiteRunner.h"
+
+int main(int argc, const char** argv)
+{
+	MarCbench::Settings settings;
+	settings.exeDir = std::filesystem::path(MarCbench::CurrExePath()).parent_path().string();
+	settings.workloadDir = MARCBENCH_WORKLOAD_DIR;
+	settings.modDirs.insert(std::filesystem::current_path().string());
+	settings.modDirs.insert(settings.exeDir);
+	settings.extDirs.insert(std::filesystem::current_path().string());
+	settings.extDirs.insert(settings.exeDir);
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string elem = argv[i];
+		bool hasNext = i + 1 < argc;
+
+		if (elem == "--help")
+		{
+			std::cout << MarCbench::HelpText << std::endl;
+			return 0;
+		}
+		else if (elem == "--verbose")
+		{
+			settings.verbose = true;
+		}
+		else if (elem == "--aligned")
+		{
+			settings.codeEncoding = MarC::BC_CodeEncoding::Aligned;
+		}
+		else if (elem == "--compact")
+		{
+			settings.codeEncoding = MarC::BC_CodeEncoding::Compact;
+		}
+		else if (elem == "--unchecked")
+		{
+			settings.unchecked = true;
+		}
+		else if (elem == "-n" || elem == "-o" || elem == "-b" || elem == "-t" || elem == "-w" || elem == "-m" || elem == "-e")
+		{
+			if (!hasNext)
+			{
+				std::cout << "Missing value for option '" << elem << "'!" << std::endl;
+				return -1;
+			}
+			std::string value = argv[++i];
+
+			try
+			{
+				if (elem == "-n")
+					settings.nRuns = std::stoull(value);
+				else if (elem == "-o")
+					settings.outFile = value;
+				else if (elem == "-b")
+					settings.baselineFile = value;
+				else if (elem == "-t")
+					settings.tolerance = std::stod(value);
+				else if (elem == "-w")
+					settings.workloadDir = value;
+				else if (elem == "-m")
+					settings.modDirs.insert(value);
+				else if (elem == "-e")
+					settings.extDirs.insert(value);
+			}
+			catch (const std::logic_error&)
+			{
+				std::cout << "Invalid value '" << value << "' for option '" << elem << "'!" << std::endl;
+				return -1;
+			}
+		}
+		else
+		{
+			settings.workloadFilter.insert(elem);
+		}
+	}
+
+	try
+	{
+		return MarCbench::SuiteRunner::run(settings);
+	}
+	catch (const MarC::MarCoreError& err)
+	{
+		std::cout << "ERROR: " << err.what() << std::endl;
+		return -1;
+	}
+}
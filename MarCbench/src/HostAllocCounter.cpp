@@ -0,0 +1,51 @@
+#include "ProcessStats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "unused.h"
+
+// Replaces the global allocation functions of the benchmark executable to count host allocations.
+// All other forms of operator new (array, nothrow) forward to these ones.
+
+namespace MarCbench
+{
+	static std::atomic<uint64_t> s_hostAllocCount(0);
+
+	uint64_t hostAllocCount()
+	{
+		return s_hostAllocCount.load(std::memory_order_relaxed);
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	MarCbench::s_hostAllocCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (size == 0)
+		size = 1;
+
+	while (true)
+	{
+		void* ptr = std::malloc(size);
+		if (ptr)
+			return ptr;
+
+		auto handler = std::get_new_handler();
+		if (!handler)
+			throw std::bad_alloc();
+		handler();
+	}
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t size) noexcept
+{
+	UNUSED(size);
+	std::free(ptr);
+}
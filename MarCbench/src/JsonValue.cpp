@@ -0,0 +1,198 @@
+#include "JsonValue.h"
+
+#include <cctype>
+#include <cstdlib>
+
+namespace MarCbench
+{
+	class JsonParser
+	{
+	public:
+		JsonParser(const std::string& text)
+			: m_text(text), m_pos(0)
+		{}
+	public:
+		JsonValue parseDocument()
+		{
+			JsonValue value = parseValue();
+			skipWhitespace();
+			if (m_pos != m_text.size())
+				error("Unexpected trailing characters!");
+			return value;
+		}
+	private:
+		JsonValue parseValue()
+		{
+			skipWhitespace();
+			if (m_pos >= m_text.size())
+				error("Unexpected end of document!");
+
+			JsonValue value;
+			char c = m_text[m_pos];
+			if (c == '{')
+			{
+				value.type = JsonValue::Type::Object;
+				++m_pos;
+				if (!consumeIf('}'))
+				{
+					do
+					{
+						skipWhitespace();
+						std::string key = parseString();
+						expect(':');
+						value.object[key] = parseValue();
+					} while (consumeIf(','));
+					expect('}');
+				}
+			}
+			else if (c == '[')
+			{
+				value.type = JsonValue::Type::Array;
+				++m_pos;
+				if (!consumeIf(']'))
+				{
+					do
+					{
+						value.array.push_back(parseValue());
+					} while (consumeIf(','));
+					expect(']');
+				}
+			}
+			else if (c == '"')
+			{
+				value.type = JsonValue::Type::String;
+				value.string = parseString();
+			}
+			else if (m_text.compare(m_pos, 4, "true") == 0)
+			{
+				value.type = JsonValue::Type::Bool;
+				value.boolean = true;
+				m_pos += 4;
+			}
+			else if (m_text.compare(m_pos, 5, "false") == 0)
+			{
+				value.type = JsonValue::Type::Bool;
+				m_pos += 5;
+			}
+			else if (m_text.compare(m_pos, 4, "null") == 0)
+			{
+				m_pos += 4;
+			}
+			else
+			{
+				const char* begin = m_text.c_str() + m_pos;
+				char* end = nullptr;
+				value.type = JsonValue::Type::Number;
+				value.number = std::strtod(begin, &end);
+				if (end == begin)
+					error("Unexpected character!");
+				m_pos += end - begin;
+			}
+
+			return value;
+		}
+		std::string parseString()
+		{
+			if (m_pos >= m_text.size() || m_text[m_pos] != '"')
+				error("Expected string!");
+			++m_pos;
+
+			std::string str;
+			while (m_pos < m_text.size() && m_text[m_pos] != '"')
+			{
+				char c = m_text[m_pos++];
+				if (c == '\\' && m_pos < m_text.size())
+				{
+					c = m_text[m_pos++];
+					switch (c)
+					{
+					case 'n': c = '\n'; break;
+					case 't': c = '\t'; break;
+					case 'r': c = '\r'; break;
+					default: break;
+					}
+				}
+				str.push_back(c);
+			}
+			if (m_pos >= m_text.size())
+				error("Unterminated string!");
+			++m_pos;
+
+			return str;
+		}
+		void skipWhitespace()
+		{
+			while (m_pos < m_text.size() && std::isspace((unsigned char)m_text[m_pos]))
+				++m_pos;
+		}
+		bool consumeIf(char c)
+		{
+			skipWhitespace();
+			if (m_pos < m_text.size() && m_text[m_pos] == c)
+			{
+				++m_pos;
+				return true;
+			}
+			return false;
+		}
+		void expect(char c)
+		{
+			if (!consumeIf(c))
+				error(std::string("Expected '") + c + "'!");
+		}
+		[[noreturn]] void error(const std::string& message)
+		{
+			throw MarC::MarCoreError("JsonError", message + " (offset " + std::to_string(m_pos) + ")");
+		}
+	private:
+		const std::string& m_text;
+		uint64_t m_pos;
+	};
+
+	const JsonValue* JsonValue::find(const std::string& key) const
+	{
+		auto it = object.find(key);
+		if (it == object.end())
+			return nullptr;
+		return &it->second;
+	}
+
+	double JsonValue::getNumber(const std::string& key, double defVal) const
+	{
+		auto value = find(key);
+		if (!value || value->type != Type::Number)
+			return defVal;
+		return value->number;
+	}
+
+	std::string JsonValue::getString(const std::string& key) const
+	{
+		auto value = find(key);
+		if (!value || value->type != Type::String)
+			return "";
+		return value->string;
+	}
+
+	JsonValue JsonValue::parse(const std::string& text)
+	{
+		return JsonParser(text).parseDocument();
+	}
+
+	void writeJsonString(std::ostream& oStream, const std::string& str)
+	{
+		oStream << '"';
+		for (char c : str)
+		{
+			switch (c)
+			{
+			case '"': oStream << "\\\""; break;
+			case '\\': oStream << "\\\\"; break;
+			case '\n': oStream << "\\n"; break;
+			case '\t': oStream << "\\t"; break;
+			case '\r': oStream << "\\r"; break;
+			default: oStream << c; break;
+			}
+		}
+		oStream << '"';
+	}
+}
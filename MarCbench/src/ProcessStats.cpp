@@ -0,0 +1,63 @@
+#include "ProcessStats.h"
+
+#include <fstream>
+#include <string>
+
+#if defined MARCBENCH_PLATFORM_WINDOWS
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#elif defined MARCBENCH_PLATFORM_UNIX
+#include <sys/resource.h>
+#endif
+
+namespace MarCbench
+{
+	#if defined MARCBENCH_PLATFORM_WINDOWS
+
+	void resetPeakRss()
+	{
+		// Windows doesn't provide a way to reset the peak working set size.
+	}
+
+	uint64_t peakRssKb()
+	{
+		PROCESS_MEMORY_COUNTERS pmc;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+			return 0;
+		return pmc.PeakWorkingSetSize / 1024;
+	}
+
+	#elif defined MARCBENCH_PLATFORM_UNIX
+
+	void resetPeakRss()
+	{
+		// Writing '5' to clear_refs resets VmHWM (Linux >= 4.0)
+		std::ofstream clearRefs("/proc/self/clear_refs");
+		if (clearRefs.is_open())
+			clearRefs << "5";
+	}
+
+	uint64_t peakRssKb()
+	{
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line))
+		{
+			if (line.rfind("VmHWM:", 0) == 0)
+				return std::stoull(line.substr(6));
+		}
+
+		// Fallback for systems without procfs, cannot be reset
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+			return 0;
+		#if defined __APPLE__
+		return usage.ru_maxrss / 1024;
+		#else
+		return usage.ru_maxrss;
+		#endif
+	}
+
+	#endif
+}
@@ -0,0 +1,202 @@
+#include "SuiteRunner.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <MarCore.h>
+
+#include "BenchTimer.h"
+#include "ProcessStats.h"
+
+namespace MarCbench
+{
+	// Counts the guest allocations without touching the timed runs.
+	struct AllocCountObserver : public MarC::InterpreterObserver
+	{
+		uint64_t nAllocs = 0;
+		uint64_t nFrees = 0;
+	public:
+		void onAllocate(MarC::Interpreter& interpreter, MarC::BC_MemAddress addr, uint64_t size) { UNUSED(interpreter); UNUSED(addr); UNUSED(size); ++nAllocs; }
+		void onFree(MarC::Interpreter& interpreter, MarC::BC_MemAddress addr) { UNUSED(interpreter); UNUSED(addr); ++nFrees; }
+	};
+
+	// Redirects std::cout into a null buffer for the lifetime of the object.
+	class CoutSink
+	{
+	public:
+		CoutSink(bool enabled)
+			: m_prevBuf(nullptr)
+		{
+			if (enabled)
+				m_prevBuf = std::cout.rdbuf(&m_nullBuf);
+		}
+		~CoutSink()
+		{
+			if (m_prevBuf)
+				std::cout.rdbuf(m_prevBuf);
+		}
+	private:
+		class NullBuf : public std::streambuf
+		{
+		protected:
+			virtual int overflow(int c) override { return c; }
+			virtual std::streamsize xsputn(const char* s, std::streamsize n) override { UNUSED(s); return n; }
+		} m_nullBuf;
+		std::streambuf* m_prevBuf;
+	};
+
+	static MarC::ExecutableInfoRef loadWorkload(const Settings& settings, const std::string& filepath)
+	{
+		auto modDirs = settings.modDirs;
+		modDirs.insert(settings.workloadDir);
+
+		auto mod = MarC::ModuleLoader::load(filepath, modDirs);
+
+		MarC::Assembler assembler(mod);
+		assembler.setCodeEncoding(settings.codeEncoding);
+		if (!assembler.assemble())
+			throw assembler.lastError();
+
+		MarC::Linker linker(assembler.getModuleInfo());
+		if (!linker.link())
+			throw linker.lastError();
+
+		if (settings.unchecked)
+		{
+			MarC::Verifier verifier(linker.getExeInfo());
+			if (!verifier.verify())
+				throw verifier.lastError();
+		}
+
+		return linker.getExeInfo();
+	}
+
+	template <class Observer>
+	static uint64_t runOnce(const Settings& settings, const Workload& workload, MarC::ExecutableInfoRef baseExeInfo, Observer& observer, Timer& timer)
+	{
+		// The interpreter writes to the static stack, every run gets its own copy of the executable.
+		auto exeInfo = std::make_shared<MarC::ExecutableInfo>(*baseExeInfo);
+
+		MarC::Interpreter interpreter(exeInfo);
+		for (auto& entry : settings.extDirs)
+			interpreter.addExtDir(entry);
+		interpreter.grantAllPerms();
+		interpreter.setUnchecked(settings.unchecked);
+		if (!interpreter.prepare())
+			throw MarC::MarCoreError("BenchError", "Workload '" + std::string(workload.name) + "' failed: " + interpreter.lastError().what());
+
+		bool intResult;
+		{
+			CoutSink sink(workload.sinkOutput);
+			timer.start();
+			intResult = interpreter.interpret(-1, observer);
+			timer.stop();
+		}
+
+		if (!intResult && !interpreter.lastError().isOK())
+			throw MarC::MarCoreError("BenchError", "Workload '" + std::string(workload.name) + "' failed: " + interpreter.lastError().what());
+
+		int64_t exitCode = interpreter.getRegister(MarC::BC_MEM_REG_EXIT_CODE).as_I_64;
+		if (exitCode != workload.expectedExitCode)
+			throw MarC::MarCoreError("BenchError", "Workload '" + std::string(workload.name) + "' exited with code " + std::to_string(exitCode) + ", expected " + std::to_string(workload.expectedExitCode) + "!");
+
+		return interpreter.nInsExecuted();
+	}
+
+	WorkloadResult SuiteRunner::runWorkload(const Settings& settings, const Workload& workload)
+	{
+		WorkloadResult result;
+		result.name = workload.name;
+
+		auto filepath = (std::filesystem::path(settings.workloadDir) / (result.name + ".mca")).string();
+		auto baseExeInfo = loadWorkload(settings, filepath);
+		result.codeBytes = baseExeInfo->codeMemory.size();
+
+		Timer timer;
+		MarC::NullObserver nullObserver;
+
+		// Warmup run, loads the extensions and warms up the caches
+		runOnce(settings, workload, baseExeInfo, nullObserver, timer);
+
+		AllocCountObserver allocObserver;
+		runOnce(settings, workload, baseExeInfo, allocObserver, timer);
+		result.guestAllocs = allocObserver.nAllocs;
+		result.guestFrees = allocObserver.nFrees;
+
+		std::vector<double> wallTimes;
+		resetPeakRss();
+		for (uint64_t i = 0; i < settings.nRuns; ++i)
+		{
+			uint64_t hostAllocsBefore = hostAllocCount();
+			result.nInstructions = runOnce(settings, workload, baseExeInfo, nullObserver, timer);
+			result.hostAllocs = hostAllocCount() - hostAllocsBefore;
+			wallTimes.push_back(timer.microseconds());
+
+			if (settings.verbose)
+				std::cout << "  " << workload.name << " run " << i + 1 << ": " << timer.microseconds() << " us" << std::endl;
+		}
+		result.peakRssKb = peakRssKb();
+
+		std::sort(wallTimes.begin(), wallTimes.end());
+		result.wallMinUs = wallTimes.front();
+		uint64_t mid = wallTimes.size() / 2;
+		result.wallMedianUs = wallTimes.size() % 2 ? wallTimes[mid] : (wallTimes[mid - 1] + wallTimes[mid]) / 2.0;
+		for (auto wallTime : wallTimes)
+			result.wallMeanUs += wallTime;
+		result.wallMeanUs /= wallTimes.size();
+		result.insPerSec = result.wallMedianUs > 0.0 ? result.nInstructions / (result.wallMedianUs / 1e6) : 0.0;
+
+		return result;
+	}
+
+	int SuiteRunner::run(const Settings& settings)
+	{
+		if (settings.nRuns == 0)
+		{
+			std::cout << "The number of runs must be greater than zero!" << std::endl;
+			return -1;
+		}
+
+		BenchReport report;
+		report.nRuns = settings.nRuns;
+
+		for (auto& workload : Workloads)
+		{
+			if (!settings.workloadFilter.empty() && settings.workloadFilter.find(workload.name) == settings.workloadFilter.end())
+				continue;
+
+			if (settings.verbose)
+				std::cout << "Running workload '" << workload.name << "'..." << std::endl;
+
+			report.workloads.push_back(runWorkload(settings, workload));
+		}
+
+		report.writeTable(std::cout);
+
+		if (!settings.outFile.empty())
+		{
+			std::ofstream outFile(settings.outFile);
+			if (!outFile.is_open())
+				throw MarC::MarCoreError("FileError", "Unable to open output file '" + settings.outFile + "'!");
+			report.writeJson(outFile);
+		}
+
+		if (settings.baselineFile.empty())
+			return 0;
+
+		auto baseline = BenchReport::loadJson(settings.baselineFile);
+
+		std::cout << std::endl << "Comparing against baseline '" << settings.baselineFile << "' (tolerance " << settings.tolerance * 100.0 << "%)..." << std::endl;
+		uint64_t nRegressions = compareReports(baseline, report, settings.tolerance, std::cout);
+		if (nRegressions == 0)
+		{
+			std::cout << "No regressions found." << std::endl;
+			return 0;
+		}
+
+		std::cout << "Found " << nRegressions << " regression(s)!" << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,110 @@
+#include "asm/AsmRunner.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include <MarCore.h>
+
+#include "BenchTimer.h"
+#include "ProcessStats.h"
+
+namespace MarCbench
+{
+	AsmPhaseTimes AsmRunner::measure(const GeneratedModule& mod)
+	{
+		AsmPhaseTimes times;
+		Timer timer;
+
+		timer.start();
+		MarC::AsmTokenizer tokenizer(mod.source);
+		if (!tokenizer.tokenize())
+			throw tokenizer.lastError();
+		timer.stop();
+		times.tokenizeNs = (double)timer.nanoseconds();
+
+		auto modPack = MarC::ModulePack::create("asmBench");
+		modPack->tokenList = tokenizer.getTokenList();
+
+		timer.start();
+		MarC::Assembler assembler(modPack);
+		if (!assembler.assemble())
+			throw assembler.lastError();
+		timer.stop();
+		times.assembleNs = (double)timer.nanoseconds();
+
+		timer.start();
+		MarC::Linker linker(assembler.getModuleInfo());
+		if (!linker.link())
+			throw linker.lastError();
+		timer.stop();
+		times.linkNs = (double)timer.nanoseconds();
+
+		return times;
+	}
+
+	static double megabytesPerSecond(uint64_t nBytes, double ns)
+	{
+		if (ns <= 0.0)
+			return 0.0;
+		return (nBytes / (1024.0 * 1024.0)) / (ns / 1e9);
+	}
+
+	int AsmRunner::run(const AsmSettings& settings)
+	{
+		if (settings.nRuns == 0 || settings.sizes.empty())
+		{
+			std::cout << "The number of runs and module sizes must not be zero!" << std::endl;
+			return -1;
+		}
+
+		std::cout << "Throughput in MB/s of source code (macro depth " << settings.macroDepth << ", one symbol per " << settings.symbolRatio << " instructions)" << std::endl;
+		std::cout << std::right
+			<< std::setw(10) << "Ins" << std::setw(10) << "Symbols" << std::setw(10) << "Src[KB]"
+			<< std::setw(12) << "Tokenize" << std::setw(12) << "Assemble" << std::setw(12) << "Link"
+			<< std::setw(12) << "Total[ms]" << std::setw(14) << "PeakRSS[KB]" << std::endl;
+
+		for (auto size : settings.sizes)
+		{
+			auto mod = generateModule(size, settings.symbolRatio, settings.macroDepth);
+
+			if (!settings.dumpDir.empty())
+			{
+				auto path = std::filesystem::path(settings.dumpDir) / ("generated_" + std::to_string(size) + ".mca");
+				std::ofstream dumpFile(path);
+				if (!dumpFile.is_open())
+					throw MarC::MarCoreError("FileError", "Unable to open output file '" + path.string() + "'!");
+				dumpFile << mod.source;
+			}
+
+			resetPeakRss();
+
+			AsmPhaseTimes best;
+			for (uint64_t i = 0; i < settings.nRuns; ++i)
+			{
+				auto times = measure(mod);
+				if (i == 0 || times.tokenizeNs < best.tokenizeNs)
+					best.tokenizeNs = times.tokenizeNs;
+				if (i == 0 || times.assembleNs < best.assembleNs)
+					best.assembleNs = times.assembleNs;
+				if (i == 0 || times.linkNs < best.linkNs)
+					best.linkNs = times.linkNs;
+			}
+
+			uint64_t nBytes = mod.source.size();
+			double totalNs = best.tokenizeNs + best.assembleNs + best.linkNs;
+			std::cout << std::fixed << std::setprecision(2)
+				<< std::setw(10) << mod.nInstructions
+				<< std::setw(10) << mod.nSymbols
+				<< std::setw(10) << nBytes / 1024
+				<< std::setw(12) << megabytesPerSecond(nBytes, best.tokenizeNs)
+				<< std::setw(12) << megabytesPerSecond(nBytes, best.assembleNs)
+				<< std::setw(12) << megabytesPerSecond(nBytes, best.linkNs)
+				<< std::setw(12) << totalNs / 1e6
+				<< std::setw(14) << peakRssKb() << std::endl;
+		}
+
+		return 0;
+	}
+}
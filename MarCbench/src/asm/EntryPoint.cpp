@@ -0,0 +1,72 @@
+#include <iostream>
+#include <sstream>
+
+#include <MarCore.h>
+
+#include "asm/AsmHelp.h"
+#include "asm/AsmRunner.h"
+
+int main(int argc, const char** argv)
+{
+	MarCbench::AsmSettings settings;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string elem = argv[i];
+
+		if (elem == "--help")
+		{
+			std::cout << MarCbench::AsmHelpText << std::endl;
+			return 0;
+		}
+		else if (elem == "-s" || elem == "-y" || elem == "-d" || elem == "-n" || elem == "-o")
+		{
+			if (i + 1 >= argc)
+			{
+				std::cout << "Missing value for option '" << elem << "'!" << std::endl;
+				return -1;
+			}
+			std::string value = argv[++i];
+
+			try
+			{
+				if (elem == "-s")
+				{
+					settings.sizes.clear();
+					std::stringstream ss(value);
+					std::string size;
+					while (std::getline(ss, size, ','))
+						settings.sizes.push_back(std::stoull(size));
+				}
+				else if (elem == "-y")
+					settings.symbolRatio = std::stoull(value);
+				else if (elem == "-d")
+					settings.macroDepth = std::stoull(value);
+				else if (elem == "-n")
+					settings.nRuns = std::stoull(value);
+				else if (elem == "-o")
+					settings.dumpDir = value;
+			}
+			catch (const std::logic_error&)
+			{
+				std::cout << "Invalid value '" << value << "' for option '" << elem << "'!" << std::endl;
+				return -1;
+			}
+		}
+		else
+		{
+			std::cout << "Unknown option '" << elem << "'!" << std::endl;
+			return -1;
+		}
+	}
+
+	try
+	{
+		return MarCbench::AsmRunner::run(settings);
+	}
+	catch (const MarC::MarCoreError& err)
+	{
+		std::cout << "ERROR: " << err.what() << std::endl;
+		return -1;
+	}
+}
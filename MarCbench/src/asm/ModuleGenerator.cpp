@@ -0,0 +1,75 @@
+#include "asm/ModuleGenerator.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace MarCbench
+{
+	GeneratedModule generateModule(uint64_t nInstructions, uint64_t symbolRatio, uint64_t macroDepth)
+	{
+		GeneratedModule mod;
+		std::stringstream ss;
+
+		uint64_t nStatics = std::max<uint64_t>(1, nInstructions / std::max<uint64_t>(1, symbolRatio));
+		uint64_t nFuncs = std::max<uint64_t>(1, nStatics / 8);
+		macroDepth = std::max<uint64_t>(1, macroDepth);
+
+		ss << "/ Generated by MarCbenchAsm\n";
+
+		for (uint64_t i = 0; i < nStatics; ++i)
+			ss << "#static : S_" << i << " : ^u64\n";
+		mod.nSymbols += nStatics;
+
+		// M_n expands to n + 1 instructions through n nested expansions
+		ss << "#macro : M_0 : dest\n\tinc.u64 : dest\n#end\n";
+		for (uint64_t i = 1; i < macroDepth; ++i)
+			ss << "#macro : M_" << i << " : dest\n\tM_" << i - 1 << " : dest\n\tadd.u64 : dest : " << i << "\n#end\n";
+
+		uint64_t nBlocks = 0;
+		while (mod.nInstructions < nInstructions)
+		{
+			uint64_t a = nBlocks % nStatics;
+			uint64_t b = (nBlocks * 7 + 3) % nStatics;
+
+			ss
+				<< "#label : B_" << nBlocks << "\n"
+				<< "\tmov.u64 : S_" << a << " : " << nBlocks << "\n"
+				<< "\tadd.u64 : S_" << a << " : @S_" << b << "\n"
+				<< "\tmul.i32 : S_" << b << " : -3\n"
+				<< "\tcall : F_" << nBlocks % nFuncs << "\n"
+				<< "\tjeq.u64 : B_" << nBlocks << " : @S_" << a << " : @S_" << b << "\n";
+			mod.nInstructions += 5;
+
+			if (nBlocks % 4 == 0)
+			{
+				ss << "\tM_" << macroDepth - 1 << " : S_" << b << "\n";
+				mod.nInstructions += macroDepth;
+			}
+
+			++nBlocks;
+		}
+		mod.nSymbols += nBlocks;
+
+		ss << "jmp : END\n";
+		++mod.nInstructions;
+
+		// Functions are defined after their first use, the linker has to resolve every call
+		for (uint64_t i = 0; i < nFuncs; ++i)
+		{
+			ss
+				<< "#func : F_" << i << "\n"
+				<< "\tinc.u64 : >>S_" << i % nStatics << "\n"
+				<< "\treturn\n"
+				<< "#end\n";
+			mod.nInstructions += 2;
+		}
+		mod.nSymbols += nFuncs;
+
+		ss << "#label : END\n";
+		mod.nSymbols += 1;
+
+		mod.source = ss.str();
+
+		return mod;
+	}
+}
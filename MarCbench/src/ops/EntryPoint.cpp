@@ -0,0 +1,64 @@
+#include <iostream>
+
+#include <MarCore.h>
+
+#include "ops/OpsHelp.h"
+#include "ops/OpsRunner.h"
+
+int main(int argc, const char** argv)
+{
+	MarCbench::OpsSettings settings;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string elem = argv[i];
+
+		if (elem == "--help")
+		{
+			std::cout << MarCbench::OpsHelpText << std::endl;
+			return 0;
+		}
+		else if (elem == "-i" || elem == "-u" || elem == "-n" || elem == "-s" || elem == "-o")
+		{
+			if (i + 1 >= argc)
+			{
+				std::cout << "Missing value for option '" << elem << "'!" << std::endl;
+				return -1;
+			}
+			std::string value = argv[++i];
+
+			try
+			{
+				if (elem == "-i")
+					settings.nIterations = std::stoull(value);
+				else if (elem == "-u")
+					settings.nUnroll = std::stoull(value);
+				else if (elem == "-n")
+					settings.nRuns = std::stoull(value);
+				else if (elem == "-s")
+					settings.nSlowest = std::stoull(value);
+				else if (elem == "-o")
+					settings.outFile = value;
+			}
+			catch (const std::logic_error&)
+			{
+				std::cout << "Invalid value '" << value << "' for option '" << elem << "'!" << std::endl;
+				return -1;
+			}
+		}
+		else
+		{
+			settings.opFilter.insert(elem);
+		}
+	}
+
+	try
+	{
+		return MarCbench::OpsRunner::run(settings);
+	}
+	catch (const MarC::MarCoreError& err)
+	{
+		std::cout << "ERROR: " << err.what() << std::endl;
+		return -1;
+	}
+}
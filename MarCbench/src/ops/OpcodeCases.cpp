@@ -0,0 +1,178 @@
+#include "ops/OpcodeCases.h"
+
+#include <cstring>
+#include <iterator>
+#include <sstream>
+
+namespace MarCbench
+{
+	using namespace MarC;
+
+	// Operands used in the generated code:
+	//   Destination: "A" -> VAL (direct), "@P" -> @PTR (PTR points to VAL)
+	//   Source: "c" -> constant (nullptr, see operandCode), "@A" -> @VAL2, "@@P" -> @@PTR2 (PTR2 points to VAL2)
+	// VAL2 always holds the value 1, so division and comparisons are well defined.
+	struct Operand
+	{
+		const char* pattern;
+		const char* code;
+	};
+
+	static const Operand DestOperands[] = {
+		{ "A", "VAL" },
+		{ "@P", "@PTR" },
+	};
+
+	static const Operand SrcOperands[] = {
+		{ "c", nullptr },
+		{ "@A", "@VAL2" },
+		{ "@@P", "@@PTR2" },
+	};
+
+	static const BC_Datatype NumericDatatypes[] = {
+		BC_DT_I_8, BC_DT_I_16, BC_DT_I_32, BC_DT_I_64,
+		BC_DT_U_8, BC_DT_U_16, BC_DT_U_32, BC_DT_U_64,
+		BC_DT_F_32, BC_DT_F_64,
+	};
+
+	// Placeholder for a label that is unique per unrolled repetition
+	static const char* LabelPlaceholder = "{L}";
+
+	// Float datatypes only accept float literals
+	static std::string literalOne(BC_Datatype dt)
+	{
+		return (dt == BC_DT_F_32 || dt == BC_DT_F_64) ? "1.0" : "1";
+	}
+
+	static std::string operandCode(const Operand& operand, BC_Datatype dt)
+	{
+		return operand.code ? operand.code : literalOne(dt);
+	}
+
+	std::string OpcodeCase::rowName() const
+	{
+		return BC_OpCodeToString(opCode) + " " + operands;
+	}
+
+	static std::string typedMnemonic(BC_OpCode oc, BC_Datatype dt)
+	{
+		if (dt == BC_DT_NONE)
+			return BC_OpCodeToString(oc);
+		return BC_OpCodeToString(oc) + "." + BC_DatatypeToString(dt);
+	}
+
+	static void addCase(std::vector<OpcodeCase>& cases, BC_OpCode oc, BC_Datatype dt, const std::string& operands, const std::string& body, uint64_t nInstructions)
+	{
+		cases.push_back({ oc, dt, operands, body, nInstructions });
+	}
+
+	std::vector<OpcodeCase> generateOpcodeCases()
+	{
+		std::vector<OpcodeCase> cases;
+
+		// Two operand arithmetic instructions
+		static const BC_OpCode BinaryOpCodes[] = { BC_OC_MOVE, BC_OC_ADD, BC_OC_SUBTRACT, BC_OC_MULTIPLY, BC_OC_DIVIDE };
+		for (auto oc : BinaryOpCodes)
+		{
+			std::vector<BC_Datatype> datatypes(std::begin(NumericDatatypes), std::end(NumericDatatypes));
+			if (oc == BC_OC_MOVE)
+				datatypes.push_back(BC_DT_ADDR);
+
+			for (auto& dest : DestOperands)
+				for (auto& src : SrcOperands)
+					for (auto dt : datatypes)
+						addCase(cases, oc, dt, std::string(dest.pattern) + "," + src.pattern,
+							typedMnemonic(oc, dt) + " : " + dest.code + " : " + operandCode(src, dt) + "\n", 1);
+		}
+
+		// Single operand instructions
+		static const BC_OpCode UnaryOpCodes[] = { BC_OC_INCREMENT, BC_OC_DECREMENT };
+		for (auto oc : UnaryOpCodes)
+			for (auto& dest : DestOperands)
+				for (auto dt : NumericDatatypes)
+					addCase(cases, oc, dt, dest.pattern, typedMnemonic(oc, dt) + " : " + dest.code + "\n", 1);
+
+		for (auto& dest : DestOperands)
+			for (auto dt : NumericDatatypes)
+				addCase(cases, BC_OC_CONVERT, dt, dest.pattern,
+					typedMnemonic(BC_OC_CONVERT, dt) + " : " + dest.code + " : " + (dt == BC_DT_I_64 ? "f64" : "i64") + "\n", 1);
+
+		// Stack instructions are measured in pairs to keep the stack balanced
+		for (auto dt : NumericDatatypes)
+			addCase(cases, BC_OC_PUSH, dt, "+pop",
+				typedMnemonic(BC_OC_PUSH, dt) + "\n" + typedMnemonic(BC_OC_POP, dt) + "\n", 2);
+
+		for (auto& src : SrcOperands)
+			for (auto dt : NumericDatatypes)
+				addCase(cases, BC_OC_PUSH_COPY, dt, std::string(src.pattern) + "+popc A",
+					typedMnemonic(BC_OC_PUSH_COPY, dt) + " : " + operandCode(src, dt) + "\n" + typedMnemonic(BC_OC_POP_COPY, dt) + " : VAL\n", 2);
+
+		addCase(cases, BC_OC_PUSH_N_BYTES, BC_DT_NONE, "c+popn c", "pushn : 8\npopn : 8\n", 2);
+		addCase(cases, BC_OC_PUSH_FRAME, BC_DT_NONE, "+popf", "pushf\npopf\n", 2);
+
+		// Jumps always target the next instruction, so taken and not taken branches behave the same
+		addCase(cases, BC_OC_JUMP, BC_DT_NONE, "L", std::string("jmp : ") + LabelPlaceholder + "\n#label : " + LabelPlaceholder + "\n", 1);
+
+		static const BC_OpCode CondJumpOpCodes[] = {
+			BC_OC_JUMP_EQUAL, BC_OC_JUMP_NOT_EQUAL,
+			BC_OC_JUMP_LESS_THAN, BC_OC_JUMP_GREATER_THAN,
+			BC_OC_JUMP_LESS_EQUAL, BC_OC_JUMP_GREATER_EQUAL,
+		};
+		static const Operand CompareOperands[][2] = {
+			{ { "c", nullptr }, { "c", nullptr } },
+			{ { "@A", "@VAL2" }, { "c", nullptr } },
+			{ { "@A", "@VAL2" }, { "@@P", "@@PTR2" } },
+		};
+		for (auto oc : CondJumpOpCodes)
+			for (auto& cmp : CompareOperands)
+				for (auto dt : NumericDatatypes)
+					addCase(cases, oc, dt, std::string("L,") + cmp[0].pattern + "," + cmp[1].pattern,
+						typedMnemonic(oc, dt) + " : " + LabelPlaceholder + " : " + operandCode(cmp[0], dt) + " : " + operandCode(cmp[1], dt) + "\n#label : " + LabelPlaceholder + "\n", 1);
+
+		addCase(cases, BC_OC_ALLOCATE, BC_DT_NONE, "A,c+free @P", "alloc : BLOCK : 16\nfree : @BLOCK\n", 2);
+		addCase(cases, BC_OC_CALL, BC_DT_NONE, "L+return", "call : NOP\n", 2);
+
+		return cases;
+	}
+
+	std::string generateOpcodeModule(const OpcodeCase* opCase, uint64_t nUnroll, uint64_t nIterations)
+	{
+		BC_Datatype initDt = BC_DT_U_64;
+		if (opCase && opCase->datatype != BC_DT_NONE)
+			initDt = opCase->datatype;
+
+		std::stringstream ss;
+		ss
+			<< "#static : VAL : 8\n"
+			<< "#static : VAL2 : 8\n"
+			<< "#static : PTR : 8\n"
+			<< "#static : PTR2 : 8\n"
+			<< "#static : BLOCK : 8\n"
+			<< "#func : NOP\n"
+			<< "\treturn\n"
+			<< "#end\n"
+			<< "mov.addr : PTR : VAL\n"
+			<< "mov.addr : PTR2 : VAL2\n"
+			<< "mov." << BC_DatatypeToString(initDt) << " : VAL2 : " << literalOne(initDt) << "\n"
+			<< "mov.u64 : $lc : " << nIterations << "\n"
+			<< "#label : LOOP\n";
+
+		if (opCase)
+		{
+			for (uint64_t i = 0; i < nUnroll; ++i)
+			{
+				std::string body = opCase->body;
+				std::string label = "L" + std::to_string(i);
+				for (auto pos = body.find(LabelPlaceholder); pos != std::string::npos; pos = body.find(LabelPlaceholder, pos))
+					body.replace(pos, std::strlen(LabelPlaceholder), label);
+				ss << body;
+			}
+		}
+
+		ss
+			<< "dec.u64 : $lc\n"
+			<< "jne.u64 : LOOP : @$lc : 0\n";
+
+		return ss.str();
+	}
+}
@@ -0,0 +1,195 @@
+#include "ops/OpsRunner.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+#include <MarCore.h>
+
+#include "BenchTimer.h"
+
+namespace MarCbench
+{
+	struct OpcodeResult
+	{
+		const OpcodeCase* opCase;
+		double nsPerIns;
+	};
+
+	static MarC::ExecutableInfoRef assembleSource(const std::string& source)
+	{
+		MarC::AsmTokenizer tokenizer(source);
+		if (!tokenizer.tokenize())
+			throw tokenizer.lastError();
+
+		auto mod = MarC::ModulePack::create("opcodeBench");
+		mod->tokenList = tokenizer.getTokenList();
+
+		MarC::Assembler assembler(mod);
+		if (!assembler.assemble())
+			throw assembler.lastError();
+
+		MarC::Linker linker(assembler.getModuleInfo());
+		if (!linker.link())
+			throw linker.lastError();
+
+		return linker.getExeInfo();
+	}
+
+	double OpsRunner::measureModule(const OpsSettings& settings, const std::string& source, uint64_t& nInsExecuted)
+	{
+		auto baseExeInfo = assembleSource(source);
+
+		double best = -1.0;
+		for (uint64_t i = 0; i < settings.nRuns; ++i)
+		{
+			auto exeInfo = std::make_shared<MarC::ExecutableInfo>(*baseExeInfo);
+			MarC::Interpreter interpreter(exeInfo);
+
+			Timer timer;
+			timer.start();
+			bool intResult = interpreter.interpret();
+			timer.stop();
+
+			if (!intResult && !interpreter.lastError().isOK())
+				throw MarC::MarCoreError("BenchError", std::string("Generated module failed: ") + interpreter.lastError().what());
+
+			nInsExecuted = interpreter.nInsExecuted();
+			double ns = (double)timer.nanoseconds();
+			if (best < 0.0 || ns < best)
+				best = ns;
+		}
+
+		return best;
+	}
+
+	static void printMatrix(const std::vector<OpcodeResult>& results, std::ostream& oStream)
+	{
+		static const MarC::BC_Datatype Columns[] = {
+			MarC::BC_DT_I_8, MarC::BC_DT_I_16, MarC::BC_DT_I_32, MarC::BC_DT_I_64,
+			MarC::BC_DT_U_8, MarC::BC_DT_U_16, MarC::BC_DT_U_32, MarC::BC_DT_U_64,
+			MarC::BC_DT_F_32, MarC::BC_DT_F_64, MarC::BC_DT_ADDR, MarC::BC_DT_NONE,
+		};
+
+		std::vector<std::string> rowOrder;
+		std::map<std::string, std::map<MarC::BC_Datatype, double>> rows;
+		for (auto& result : results)
+		{
+			auto name = result.opCase->rowName();
+			if (rows.find(name) == rows.end())
+				rowOrder.push_back(name);
+			rows[name][result.opCase->datatype] = result.nsPerIns;
+		}
+
+		oStream << "ns/instruction (pairs like push+pop report the mean of both instructions)" << std::endl;
+		oStream << std::left << std::setw(24) << "Instruction" << std::right;
+		for (auto dt : Columns)
+			oStream << std::setw(8) << (dt == MarC::BC_DT_NONE ? "-" : MarC::BC_DatatypeToString(dt));
+		oStream << std::endl;
+
+		oStream << std::fixed << std::setprecision(1);
+		for (auto& name : rowOrder)
+		{
+			auto& row = rows[name];
+			oStream << std::left << std::setw(24) << name << std::right;
+			for (auto dt : Columns)
+			{
+				auto it = row.find(dt);
+				if (it == row.end())
+					oStream << std::setw(8) << ".";
+				else
+					oStream << std::setw(8) << it->second;
+			}
+			oStream << std::endl;
+		}
+	}
+
+	static void printSlowest(std::vector<OpcodeResult> results, uint64_t nSlowest, std::ostream& oStream)
+	{
+		// Everything is put in relation to the cheapest possible move
+		double reference = 0.0;
+		for (auto& result : results)
+			if (result.opCase->opCode == MarC::BC_OC_MOVE && result.opCase->datatype == MarC::BC_DT_U_64 && result.opCase->operands == "A,c")
+				reference = result.nsPerIns;
+
+		std::sort(results.begin(), results.end(), [](const OpcodeResult& a, const OpcodeResult& b) { return a.nsPerIns > b.nsPerIns; });
+
+		oStream << std::endl << "Slowest combinations";
+		if (reference > 0.0)
+			oStream << " (relative to 'mov.u64 A,c': " << reference << " ns)";
+		oStream << ":" << std::endl;
+
+		for (uint64_t i = 0; i < nSlowest && i < results.size(); ++i)
+		{
+			auto& result = results[i];
+			auto& opCase = *result.opCase;
+			std::string name = MarC::BC_OpCodeToString(opCase.opCode);
+			if (opCase.datatype != MarC::BC_DT_NONE)
+				name += "." + MarC::BC_DatatypeToString(opCase.datatype);
+			name += " " + opCase.operands;
+
+			oStream << "  " << std::left << std::setw(28) << name << std::right << std::setw(8) << result.nsPerIns << " ns";
+			if (reference > 0.0)
+				oStream << std::setw(8) << result.nsPerIns / reference << "x";
+			oStream << std::endl;
+		}
+	}
+
+	int OpsRunner::run(const OpsSettings& settings)
+	{
+		if (settings.nRuns == 0 || settings.nIterations == 0 || settings.nUnroll == 0)
+		{
+			std::cout << "The number of runs, iterations and unrolled repetitions must be greater than zero!" << std::endl;
+			return -1;
+		}
+
+		auto cases = generateOpcodeCases();
+
+		uint64_t nLoopIns = 0;
+		double loopNs = measureModule(settings, generateOpcodeModule(nullptr, settings.nUnroll, settings.nIterations), nLoopIns);
+
+		std::vector<OpcodeResult> results;
+		for (auto& opCase : cases)
+		{
+			if (!settings.opFilter.empty() && settings.opFilter.find(MarC::BC_OpCodeToString(opCase.opCode)) == settings.opFilter.end())
+				continue;
+
+			uint64_t nIns = 0;
+			double ns = measureModule(settings, generateOpcodeModule(&opCase, settings.nUnroll, settings.nIterations), nIns);
+
+			// Subtract the loop overhead, only the unrolled body remains
+			double nsPerIns = std::max(0.0, ns - loopNs) / (nIns - nLoopIns);
+			results.push_back({ &opCase, nsPerIns });
+		}
+
+		if (results.empty())
+		{
+			std::cout << "No instruction matches the given filter!" << std::endl;
+			return -1;
+		}
+
+		printMatrix(results, std::cout);
+		printSlowest(results, settings.nSlowest, std::cout);
+
+		if (!settings.outFile.empty())
+		{
+			std::ofstream outFile(settings.outFile);
+			if (!outFile.is_open())
+				throw MarC::MarCoreError("FileError", "Unable to open output file '" + settings.outFile + "'!");
+
+			outFile << "opcode,datatype,operands,nsPerIns" << std::endl;
+			for (auto& result : results)
+			{
+				auto& opCase = *result.opCase;
+				outFile << MarC::BC_OpCodeToString(opCase.opCode) << ","
+					<< (opCase.datatype == MarC::BC_DT_NONE ? "" : MarC::BC_DatatypeToString(opCase.datatype)) << ","
+					<< opCase.operands << ","
+					<< std::fixed << std::setprecision(3) << result.nsPerIns << std::endl;
+			}
+		}
+
+		return 0;
+	}
+}
@@ -4,5 +4,5 @@
 
 namespace MarCmd
 {
-	MarC::ExecutableInfoRef autoLoadExecutable(const std::string& inFile, const std::set<std::string>& modDirs);
+	MarC::ExecutableInfoRef autoLoadExecutable(const std::string& inFile, const std::set<std::string>& modDirs, MarC::BuildCacheRef buildCache = nullptr);
 }
\ No newline at end of file
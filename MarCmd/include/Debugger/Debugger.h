@@ -34,6 +34,17 @@ namespace MarCmd
 	};
 	typedef std::shared_ptr<SharedDebugData> SharedDebugDataRef;
 
+	class CallstackObserver : public MarC::InterpreterObserver
+	{
+	public:
+		CallstackObserver(SharedDebugDataRef sdd);
+	public:
+		void onCall(MarC::Interpreter& interpreter, MarC::BC_MemAddress funcAddr);
+		void onReturn(MarC::Interpreter& interpreter, MarC::BC_MemAddress retAddr);
+	private:
+		SharedDebugDataRef m_sdd;
+	};
+
 	class Debugger;
 
 	typedef std::shared_ptr<class DisasmWindow> DisasmWindowRef;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "MarCmdSettings.h"
 
 namespace MarCmd
@@ -8,5 +10,13 @@ namespace MarCmd
 	{
 	public:
 		static int run(const Settings& settings);
+	private:
+		// Assembles every module into its own object (*.mco) in 'objDir', objects of unchanged modules already in there are reused.
+		// The entry module's object comes last.
+		static std::vector<MarC::ModuleInfoRef> buildObjects(const std::string& inFile, const std::string& objDir, const std::set<std::string>& modDirs, MarC::BC_CodeEncoding encoding, bool verbose);
+		// The object of the module in 'objDir' if it got assembled from the same tokens and required objects, nullptr otherwise.
+		static MarC::ModuleInfoRef loadUnchangedObject(const std::string& modName, const MarC::AsmTokenList& tokenList, const std::string& objDir, MarC::BC_CodeEncoding encoding, const MarC::ObjectResolver& resolveObject);
+		static void saveObject(const MarC::ModuleInfo& object, const std::string& objDir, bool verbose);
+		static void optimize(MarC::ExecutableInfoRef exeInfo, uint64_t level, uint64_t inlineLimit, bool verbose);
 	};
 }
\ No newline at end of file
@@ -12,5 +12,7 @@ namespace MarCmd
 		GrantAll,
 		NoExitInfo,
 		ForceRefresh,
+		NoCache,
+		Verify,
 	};
 }
@@ -9,7 +9,7 @@ namespace MarCmd
 		"  Modes (If none selected, pass a single *.mcc/*.mca/*.mco/*.mce file to interpret):\n"
 		"    --livecode        Live interpret MarC code from the console.\n"
 		"    --liveasm         Live interpret MarCembly code from the console.\n"
-		"    --build           Comile/Assemble/Link a *.mcc/*.mca file.\n"
+		"    --build           Comile/Assemble/Link a *.mcc/*.mca/*.mco file. Writes an object (*.mco) per module next to the output, reuses the unchanged ones.\n"
 		"    --disasm          Disassemble a *.mce file and store the modules disassemblies in the output directory.\n"
 		"    --debug           Debug a *.mcc/*.mca/*.mce file.\n"
 		"    --interpret       Interpret a *.mcc/*.mca/*.mce file.\n"
@@ -17,6 +17,13 @@ namespace MarCmd
 		"    -o [filepath]     Output file.\n"
 		"    -m [directory]    Directory to search for modules in (Can be used multiple times).\n"
 		"    -e [directory]    Directory to search for extensions in (Can be used multiple times).\n"
+		"    -O[level]         With 'build' switch: Optimize the linked bytecode (Level 1 if omitted, 0 disables it).\n"
+		"                      Level 1: Peephole rewrites. Level 2: Also folds constant branches, turns tail calls into jumps, removes unreachable code and unused static data.\n"
+		"    --inline          With 'build' switch: Inline calls of small leaf functions and list the inlined call sites.\n"
+		"    --aligned         With 'build' switch: Pad instructions and their operands to their natural alignment (larger code, no unaligned reads).\n"
+		"    --compact         With 'build' switch: Encode address operands with as few bytes as possible (smaller code).\n"
+		"    --verify          With 'interpret' switch: Verify the executable before running it, refuse it on failure and run it without runtime checks.\n"
+		"    --nocache         Don't use the build cache and file index ($MARC_CACHE_DIR or a directory in the temp directory).\n"
 		"  Exit behavior: (Default: Keeps MarCmd open when the exit code is non-zero.)\n"
 		"    --keeponexit      Keep MarCmd open after the execution has finished.\n"
 		"    --closeonexit     Close MarCmd after the execution has finished.\n"
@@ -26,6 +26,10 @@ namespace MarCmd
 		std::string exeDir = "";
 		std::set<std::string> modDirs;
 		std::set<std::string> extDirs;
+		MarC::BuildCacheRef buildCache;
+		uint64_t optLevel = 0;
+		uint64_t inlineLimit = 0; // Max. number of instructions of inlined functions, 0 disables inlining.
+		MarC::BC_CodeEncoding codeEncoding = MarC::BC_CodeEncoding::Packed;
 		ExitBehavior exitBehavior = ExitBehavior::CloseWhenZero;
 	};
 }
\ No newline at end of file
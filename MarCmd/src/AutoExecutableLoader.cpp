@@ -2,7 +2,7 @@
 
 namespace MarCmd
 {
-	MarC::ExecutableInfoRef autoLoadExecutable(const std::string& inFile, const std::set<std::string>& modDirs)
+	MarC::ExecutableInfoRef autoLoadExecutable(const std::string& inFile, const std::set<std::string>& modDirs, MarC::BuildCacheRef buildCache)
 	{
 		MarC::ExecutableInfoRef exeInfo = nullptr;
 		auto extension = MarC::modExtFromPath(inFile);
@@ -14,8 +14,25 @@ namespace MarCmd
 		{
 			exeInfo = MarC::ExecutableLoader::load(inFile);
 		}
+		else if (extension == ".mco")
+		{
+			MarC::Linker linker(MarC::ObjectLoader::loadWithDependencies(inFile, modDirs));
+			if (!linker.link())
+				throw linker.lastError();
+
+			exeInfo = linker.getExeInfo();
+		}
 		else if (extension == ".mca")
 		{
+			MarC::BuildCache::Key cacheKey;
+			if (buildCache)
+			{
+				cacheKey = buildCache->makeKey("exe", inFile, modDirs);
+				exeInfo = buildCache->loadExecutable(cacheKey);
+				if (exeInfo)
+					return exeInfo;
+			}
+
 			auto mod = MarC::ModuleLoader::load(inFile, modDirs);
 
 			MarC::Assembler assembler(mod);
@@ -27,6 +44,9 @@ namespace MarCmd
 				throw linker.lastError();
 
 			exeInfo = linker.getExeInfo();
+
+			if (buildCache)
+				buildCache->storeExecutable(cacheKey, *exeInfo);
 		}
 		else
 		{
@@ -19,16 +19,17 @@ namespace MarCmd
 		m_modIndex = modIndex;
 
 		auto& mem = m_sdd->interpreter->getExeInfo()->codeMemory;
+		auto encoding = m_sdd->interpreter->getExeInfo()->codeEncoding;
 
 		uint64_t nDisassembled = 0;
 		while (nDisassembled < mem.size())
 		{
 			ModDisasmInfo::InsInfo insInfo;
-			insInfo.data = MarC::Disassembler::disassemble((char*)mem.getBaseAddress() + nDisassembled);
+			insInfo.data = MarC::Disassembler::disassemble((char*)mem.getBaseAddress() + nDisassembled, encoding);
 			insInfo.str = MarC::DisAsmInsInfoToString(insInfo.data, m_sdd->interpreter->getExeInfo()->symbols);
 			m_modDisasmInfo.ins.push_back(insInfo);
 			m_modDisasmInfo.instructionOffsets.push_back(nDisassembled);
-			nDisassembled += m_modDisasmInfo.ins.back().data.rawData.size();
+			nDisassembled = MarC::BC_AlignOffset(nDisassembled + insInfo.data.rawData.size(), MarC::BC_InstructionAlignment(encoding));
 		}
 
 		this->setRatio(Console::WRT::AbsoluteTop, 1);
@@ -191,6 +192,27 @@ namespace MarCmd
 		return temp;
 	}
 
+	CallstackObserver::CallstackObserver(SharedDebugDataRef sdd)
+		: m_sdd(sdd)
+	{}
+
+	void CallstackObserver::onCall(MarC::Interpreter& interpreter, MarC::BC_MemAddress funcAddr)
+	{
+		UNUSED(interpreter);
+		std::lock_guard lock(m_sdd->mtxCallstack);
+		++m_sdd->callstackModifyCount;
+		m_sdd->callstack.push_back(funcAddr);
+	}
+
+	void CallstackObserver::onReturn(MarC::Interpreter& interpreter, MarC::BC_MemAddress retAddr)
+	{
+		UNUSED(interpreter);
+		UNUSED(retAddr);
+		std::lock_guard lock(m_sdd->mtxCallstack);
+		++m_sdd->callstackModifyCount;
+		m_sdd->callstack.pop_back();
+	}
+
 	int Debugger::run(const Settings& settings)
 	{
 		auto dbgr = Debugger(settings);
@@ -202,7 +224,7 @@ namespace MarCmd
 	{
 		m_sharedDebugData = std::make_shared<SharedDebugData>();
 
-		m_sharedDebugData->exeInfo = autoLoadExecutable(settings.inFile, settings.modDirs);
+		m_sharedDebugData->exeInfo = autoLoadExecutable(settings.inFile, settings.modDirs, settings.buildCache);
 
 		for (auto& sym : m_sharedDebugData->exeInfo->symbols)
 		{
@@ -360,6 +382,7 @@ namespace MarCmd
 	{
 		auto& sdd = m_sharedDebugData;
 		auto& regCP = m_sharedDebugData->interpreter->getRegister(MarC::BC_MEM_REG_CODE_POINTER);
+		CallstackObserver observer(m_sharedDebugData);
 		while (!m_sharedDebugData->interpreter->lastError() && !sdd->stopExecution)
 		{
 			{
@@ -384,7 +407,7 @@ namespace MarCmd
 					// Get information about the next instruction to execute
 					const auto& insInfo = m_wndDisasm->getDisasmInfo().ins[m_wndDisasm->getDisasmInfo().addrToLine(regCP.as_ADDR)].data;
 
-					m_sharedDebugData->interpreter->interpret(1);
+					m_sharedDebugData->interpreter->interpret(1, observer);
 
 					// Update symbol datatype;
 					if (false)
@@ -410,29 +433,6 @@ namespace MarCmd
 						}
 					}
 
-					switch(insInfo.ocx.opCode)
-					{
-					case MarC::BC_OC_CALL:
-					{
-						std::lock_guard lock(m_sharedDebugData->mtxCallstack);
-						++m_sharedDebugData->callstackModifyCount;
-						MarC::BC_MemAddress funcAddr = insInfo.args[0].value.cell.as_ADDR;
-						for (MarC::DerefCount i = 0; i < insInfo.args[0].derefCount; ++i)
-							funcAddr = m_sharedDebugData->interpreter->hostMemCell(funcAddr).as_ADDR;
-						m_sharedDebugData->callstack.push_back(funcAddr);
-						break;
-					}
-					case MarC::BC_OC_RETURN:
-					{
-						std::lock_guard lock(m_sharedDebugData->mtxCallstack);
-						++m_sharedDebugData->callstackModifyCount;
-						m_sharedDebugData->callstack.pop_back();
-						break;
-					}
-					default:
-						;
-					}
-
 					lock.lock();
 
 					ignoreBreakpoint = false;
@@ -85,6 +85,34 @@ int main(int argc, const char** argv, const char** env)
 			}
 			settings.outFile = cmd.getNext();
 		}
+		else if (elem.rfind("-O", 0) == 0)
+		{
+			if (elem.size() == 2)
+			{
+				settings.optLevel = 1;
+			}
+			else if (elem.find_first_not_of("0123456789", 2) == std::string::npos)
+			{
+				settings.optLevel = std::stoull(elem.substr(2));
+			}
+			else
+			{
+				std::cout << "Invalid optimization level '" << elem.substr(2) << "'!" << std::endl;
+				return -1;
+			}
+		}
+		else if (elem == "--inline")
+		{
+			settings.inlineLimit = MarC::Optimizer::DefaultInlineLimit;
+		}
+		else if (elem == "--aligned")
+		{
+			settings.codeEncoding = MarC::BC_CodeEncoding::Aligned;
+		}
+		else if (elem == "--compact")
+		{
+			settings.codeEncoding = MarC::BC_CodeEncoding::Compact;
+		}
 		else if (elem == "-m")
 		{
 			if (!cmd.hasNext())
@@ -123,6 +151,14 @@ int main(int argc, const char** argv, const char** env)
 		{
 		  settings.flags.setFlag(MarCmd::CmdFlags::ForceRefresh);
 		}
+		else if (elem == "--nocache")
+		{
+			settings.flags.setFlag(MarCmd::CmdFlags::NoCache);
+		}
+		else if (elem == "--verify")
+		{
+			settings.flags.setFlag(MarCmd::CmdFlags::Verify);
+		}
 		else if (elem == "--profile")
 		{
 			settings.flags.setFlag(MarCmd::CmdFlags::Profile);
@@ -149,6 +185,21 @@ int main(int argc, const char** argv, const char** env)
 		settings.mode = Mode::Interpret;
 	}
 
+	if (!settings.flags.hasFlag(MarCmd::CmdFlags::NoCache))
+	{
+		// Entries created by a different MarCmd binary are ignored, the assembler/linker may have changed.
+		std::error_code ec;
+		auto exePath = MarCmd::CurrExePath();
+		auto exeSize = std::filesystem::file_size(exePath, ec);
+		auto exeTime = std::filesystem::last_write_time(exePath, ec).time_since_epoch().count();
+		auto cacheDir = MarC::BuildCache::defaultDir();
+		if (!cacheDir.empty())
+		{
+			settings.buildCache = MarC::BuildCache::create(cacheDir, std::to_string(exeSize) + ":" + std::to_string(exeTime));
+			MarC::FileIndex::setPersistDir(cacheDir);
+		}
+	}
+
 	if (settings.flags.hasFlag(MarCmd::CmdFlags::Verbose))
 		settings.flags.clrFlag(MarCmd::CmdFlags::NoExitInfo);
 
@@ -1,6 +1,8 @@
 #include "MarCmdBuilder.h"
 
 #include <fstream>
+#include <algorithm>
+#include <functional>
 #include <filesystem>
 #include <MarCore.h>
 
@@ -12,14 +14,65 @@ namespace MarCmd
 	{
 		bool verbose = settings.flags.hasFlag(CmdFlags::Verbose);
 
-		auto exeInfo = autoLoadExecutable(settings.inFile, settings.modDirs);
-
 		std::string outFile;
 		if (!settings.outFile.empty())
 			outFile = settings.outFile;
 		else
 			outFile = std::filesystem::path(settings.inFile).replace_extension(".mce").string();
 
+		MarC::ExecutableInfoRef exeInfo;
+		if (MarC::modExtFromPath(settings.inFile) == ".mca")
+		{
+			auto objDir = std::filesystem::absolute(outFile).parent_path();
+
+			MarC::BuildCache::Key cacheKey;
+			std::vector<MarC::ModuleInfoRef> objects;
+			if (settings.buildCache)
+			{
+				std::string kind = "build";
+				if (settings.optLevel > 0)
+					kind.append("-O" + std::to_string(settings.optLevel));
+				if (settings.inlineLimit > 0)
+					kind.append("-inline" + std::to_string(settings.inlineLimit));
+				if (settings.codeEncoding == MarC::BC_CodeEncoding::Aligned)
+					kind.append("-aligned");
+				else if (settings.codeEncoding == MarC::BC_CodeEncoding::Compact)
+					kind.append("-compact");
+				cacheKey = settings.buildCache->makeKey(kind, settings.inFile, settings.modDirs);
+				if (settings.buildCache->loadBuild(cacheKey, exeInfo, objects))
+				{
+					if (verbose)
+						std::cout << "Using cached build from '" << settings.buildCache->getCacheDir() << "'..." << std::endl;
+					for (auto& object : objects)
+						saveObject(*object, objDir.string(), verbose);
+				}
+				else
+				{
+					exeInfo = nullptr;
+				}
+			}
+
+			if (!exeInfo)
+			{
+				objects = buildObjects(settings.inFile, objDir.string(), settings.modDirs, settings.codeEncoding, verbose);
+
+				MarC::Linker linker(objects);
+				if (!linker.link())
+					throw linker.lastError();
+
+				exeInfo = linker.getExeInfo();
+				optimize(exeInfo, settings.optLevel, settings.inlineLimit, verbose);
+
+				if (settings.buildCache)
+					settings.buildCache->storeBuild(cacheKey, *exeInfo, objects);
+			}
+		}
+		else
+		{
+			exeInfo = autoLoadExecutable(settings.inFile, settings.modDirs, settings.buildCache);
+			optimize(exeInfo, settings.optLevel, settings.inlineLimit, verbose);
+		}
+
 		std::ofstream oStream(outFile, std::ios::binary | std::ios::out | std::ios::trunc);
 		if (!oStream.is_open())
 		{
@@ -43,4 +96,129 @@ namespace MarCmd
 
 		return 0;
 	}
+
+	std::vector<MarC::ModuleInfoRef> Builder::buildObjects(const std::string& inFile, const std::string& objDir, const std::set<std::string>& modDirs, MarC::BC_CodeEncoding encoding, bool verbose)
+	{
+		auto mod = MarC::ModuleLoader::load(inFile, modDirs);
+
+		std::map<std::string, MarC::ModuleInfoRef> objects;
+		std::set<std::string> inProgress;
+		std::vector<MarC::ModuleInfoRef> linkOrder;
+
+		std::function<MarC::ModuleInfoRef(const std::string&, MarC::AsmTokenListRef)> buildObject;
+		MarC::ObjectResolver resolveObject = [&](const std::string& depName) -> MarC::ModuleInfoRef {
+			auto itObj = objects.find(depName);
+			if (itObj != objects.end())
+				return itObj->second;
+			auto itDep = mod->dependencies.find(depName);
+			if (itDep == mod->dependencies.end() || inProgress.find(depName) != inProgress.end())
+				return nullptr;
+			return buildObject(depName, itDep->second);
+		};
+
+		buildObject = [&](const std::string& modName, MarC::AsmTokenListRef tokenList)
+		{
+			inProgress.insert(modName);
+
+			auto object = loadUnchangedObject(modName, *tokenList, objDir, encoding, resolveObject);
+			if (object)
+			{
+				if (verbose)
+					std::cout << "Reusing unchanged object of module '" << modName << "'..." << std::endl;
+			}
+			else
+			{
+				auto modPack = MarC::ModulePack::create(modName);
+				modPack->tokenList = tokenList;
+
+				MarC::Assembler assembler(modPack);
+				assembler.setCodeEncoding(encoding);
+				assembler.setObjectResolver(resolveObject);
+
+				if (!assembler.assemble())
+					throw assembler.lastError();
+
+				object = assembler.getModuleInfo();
+				object->exeInfo->name = modName;
+
+				// All required objects have been resolved while assembling.
+				std::vector<MarC::ModuleInfoRef> requiredObjects;
+				for (auto& reqName : object->requiredModules)
+					requiredObjects.push_back(objects.at(reqName));
+				object->sourceHash = MarC::ObjectLoader::sourceHash(*tokenList, encoding, requiredObjects);
+				object->interfaceHash = MarC::ObjectLoader::interfaceHash(*object, requiredObjects);
+
+				saveObject(*object, objDir, verbose);
+			}
+
+			objects.insert({ modName, object });
+			linkOrder.push_back(object);
+			inProgress.erase(modName);
+
+			return object;
+		};
+
+		buildObject(mod->name, mod->tokenList);
+
+		return linkOrder;
+	}
+
+	MarC::ModuleInfoRef Builder::loadUnchangedObject(const std::string& modName, const MarC::AsmTokenList& tokenList, const std::string& objDir, MarC::BC_CodeEncoding encoding, const MarC::ObjectResolver& resolveObject)
+	{
+		auto objPath = (std::filesystem::path(objDir) / (modName + ".mco")).string();
+		if (!std::filesystem::exists(objPath))
+			return nullptr;
+
+		MarC::ModuleInfoRef object;
+		try
+		{
+			object = MarC::ObjectLoader::load(objPath);
+		}
+		catch (const MarC::MarCoreError&)
+		{
+			// Objects written by other versions get assembled again.
+			return nullptr;
+		}
+
+		// The objects it requires come first, they get rebuilt if they changed and their interfaces are part of the hash.
+		std::vector<MarC::ModuleInfoRef> requiredObjects;
+		for (auto& reqName : object->requiredModules)
+		{
+			auto reqObject = resolveObject(reqName);
+			if (!reqObject)
+				return nullptr;
+			requiredObjects.push_back(reqObject);
+		}
+
+		if (object->sourceHash == 0 || object->sourceHash != MarC::ObjectLoader::sourceHash(tokenList, encoding, requiredObjects))
+			return nullptr;
+
+		object->exeInfo->name = modName;
+		return object;
+	}
+
+	void Builder::saveObject(const MarC::ModuleInfo& object, const std::string& objDir, bool verbose)
+	{
+		auto objPath = (std::filesystem::path(objDir) / (object.exeInfo->name + ".mco")).string();
+		if (verbose)
+			std::cout << "Writing object '" << objPath << "' to disk..." << std::endl;
+		MarC::ObjectLoader::save(object, objPath);
+	}
+
+	void Builder::optimize(MarC::ExecutableInfoRef exeInfo, uint64_t level, uint64_t inlineLimit, bool verbose)
+	{
+		if (level == 0 && inlineLimit == 0)
+			return;
+
+		if (verbose)
+			std::cout << "Optimizing the executable..." << std::endl;
+
+		// Inlining runs on top of the peephole rewrites.
+		MarC::Optimizer optimizer(exeInfo, std::max<uint64_t>(level, 1));
+		optimizer.setInlineLimit(inlineLimit);
+		optimizer.optimize();
+
+		if (verbose || inlineLimit > 0 || !optimizer.getReport().skipReason.empty())
+			std::cout << MarC::OptimizerReportToString(optimizer.getReport()) << std::endl;
+	}
 }
\ No newline at end of file
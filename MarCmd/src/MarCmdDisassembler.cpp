@@ -11,7 +11,7 @@ namespace MarCmd
 	{
 		bool verbose = settings.flags.hasFlag(CmdFlags::Verbose);
 
-		auto exeInfo = autoLoadExecutable(settings.inFile, settings.modDirs);
+		auto exeInfo = autoLoadExecutable(settings.inFile, settings.modDirs, settings.buildCache);
 
 		if (verbose)
 			std::cout << "Creating the output directory..." << std::endl;
@@ -42,11 +42,11 @@ namespace MarCmd
 			uint64_t nDisassembled = 0;
 			while (nDisassembled < codeMem.size())
 			{
-				auto daii = MarC::Disassembler::disassemble((char*)codeMem.getBaseAddress() + nDisassembled);
+				auto daii = MarC::Disassembler::disassemble((char*)codeMem.getBaseAddress() + nDisassembled, exeInfo->codeEncoding);
 
 				source.append(MarC::DisAsmInsInfoToString(daii, exeInfo->symbols));
 
-				nDisassembled += daii.rawData.size();
+				nDisassembled = MarC::BC_AlignOffset(nDisassembled + daii.rawData.size(), MarC::BC_InstructionAlignment(exeInfo->codeEncoding));
 				
 				if (nDisassembled < codeMem.size())
 					source.push_back('\n');
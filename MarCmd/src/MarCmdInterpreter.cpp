@@ -14,9 +14,24 @@ namespace MarCmd
 	{
 		bool verbose = settings.flags.hasFlag(CmdFlags::Verbose);
 
-		auto exeInfo = autoLoadExecutable(settings.inFile, settings.modDirs);
+		auto exeInfo = autoLoadExecutable(settings.inFile, settings.modDirs, settings.buildCache);
+
+		bool verify = settings.flags.hasFlag(CmdFlags::Verify);
+		if (verify)
+		{
+			if (verbose)
+				std::cout << "Verifying the executable..." << std::endl;
+			MarC::Verifier verifier(exeInfo);
+			if (!verifier.verify())
+			{
+				std::cout << std::endl << "The executable failed the verification!" << std::endl
+					<< "    " << verifier.lastError().what() << std::endl;
+				return -1;
+			}
+		}
 
 		MarC::Interpreter interpreter(exeInfo);
+		interpreter.setUnchecked(verify);
 		for (auto& entry : settings.extDirs)
 			interpreter.addExtDir(entry);
 
@@ -42,6 +57,15 @@ namespace MarCmd
 			}
 		}
 
+		if (verbose)
+			std::cout << "Loading extensions..." << std::endl;
+		if (!interpreter.prepare())
+		{
+			std::cout << std::endl << "An error occured while loading the extensions!" << std::endl
+				<< "    " << interpreter.lastError().what() << std::endl;
+			return -1;
+		}
+
 		Timer timer;
 		if (verbose)
 			std::cout << "Starting interpreter..." << std::endl;
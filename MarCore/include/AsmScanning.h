@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#if defined(__AVX2__)
+	#define MARC_ASM_SCAN_AVX2
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define MARC_ASM_SCAN_SSE2
+	#include <emmintrin.h>
+#endif
+
+// Run scanners used by the AsmTokenizer to skip over characters that don't end the current token.
+// Each scanner returns the index of the first character at or after 'pos' that doesn't belong to the run.
+// The scanned string must be NUL-terminated at code[code.size()] (as std::string is), the NUL always ends a run.
+namespace MarC
+{
+	namespace AsmScan
+	{
+		inline bool isBlank(char c) { return c == ' ' || c == '\t'; }
+		inline bool isDigit(char c) { return uint8_t(c - '0') < 10; }
+		inline bool isNameChar(char c) { return isDigit(c) || uint8_t((c | 0x20) - 'a') < 26 || c == '_' || c == '>'; }
+		inline bool isNotNewline(char c) { return c != '\n' && c != '\0'; }
+
+	#if defined(MARC_ASM_SCAN_AVX2)
+		typedef __m256i Block;
+		inline Block load(const char* p) { return _mm256_loadu_si256((const __m256i*)p); }
+		inline Block splat(char c) { return _mm256_set1_epi8(c); }
+		inline Block eq(Block a, Block b) { return _mm256_cmpeq_epi8(a, b); }
+		inline Block lt(Block a, Block b) { return _mm256_cmpgt_epi8(b, a); }
+		inline Block orb(Block a, Block b) { return _mm256_or_si256(a, b); }
+		inline Block sub(Block a, Block b) { return _mm256_sub_epi8(a, b); }
+		inline uint32_t mask(Block a) { return (uint32_t)_mm256_movemask_epi8(a); }
+		constexpr uint64_t BlockSize = 32;
+		constexpr uint32_t FullMask = 0xFFFFFFFF;
+	#elif defined(MARC_ASM_SCAN_SSE2)
+		typedef __m128i Block;
+		inline Block load(const char* p) { return _mm_loadu_si128((const __m128i*)p); }
+		inline Block splat(char c) { return _mm_set1_epi8(c); }
+		inline Block eq(Block a, Block b) { return _mm_cmpeq_epi8(a, b); }
+		inline Block lt(Block a, Block b) { return _mm_cmplt_epi8(a, b); }
+		inline Block orb(Block a, Block b) { return _mm_or_si128(a, b); }
+		inline Block sub(Block a, Block b) { return _mm_sub_epi8(a, b); }
+		inline uint32_t mask(Block a) { return (uint32_t)_mm_movemask_epi8(a); }
+		constexpr uint64_t BlockSize = 16;
+		constexpr uint32_t FullMask = 0xFFFF;
+	#endif
+
+	#if defined(MARC_ASM_SCAN_AVX2) || defined(MARC_ASM_SCAN_SSE2)
+		// Unsigned range check 'lo <= c <= hi' built from the signed compare available in SSE2.
+		inline Block inRange(Block v, char lo, char hi)
+		{
+			Block rel = sub(sub(v, splat(lo)), splat((char)0x80));
+			return lt(rel, splat((char)(hi - lo + 1 - 0x80)));
+		}
+
+		inline Block blankBlock(Block v) { return orb(eq(v, splat(' ')), eq(v, splat('\t'))); }
+		inline Block digitBlock(Block v) { return inRange(v, '0', '9'); }
+		inline Block nameCharBlock(Block v)
+		{
+			Block alpha = inRange(orb(v, splat(0x20)), 'a', 'z');
+			return orb(orb(digitBlock(v), alpha), orb(eq(v, splat('_')), eq(v, splat('>'))));
+		}
+		inline Block notNewlineBlock(Block v)
+		{
+			Block end = orb(eq(v, splat('\n')), eq(v, splat('\0')));
+			return eq(end, splat(0));
+		}
+
+		template <typename VecPred, typename Pred>
+		uint64_t scan(const std::string& code, uint64_t pos, VecPred vecPred, Pred pred)
+		{
+			const char* data = code.data();
+			uint64_t size = code.size();
+			while (pos + BlockSize <= size)
+			{
+				uint32_t m = mask(vecPred(load(data + pos)));
+				if (m != FullMask)
+				{
+					m = ~m & FullMask;
+				#if defined(_MSC_VER)
+					unsigned long first;
+					_BitScanForward(&first, m);
+					return pos + first;
+				#else
+					return pos + (uint64_t)__builtin_ctz(m);
+				#endif
+				}
+				pos += BlockSize;
+			}
+			while (pred(data[pos]))
+				++pos;
+			return pos;
+		}
+
+		inline uint64_t skipBlanks(const std::string& code, uint64_t pos) { return scan(code, pos, blankBlock, isBlank); }
+		inline uint64_t skipDigits(const std::string& code, uint64_t pos) { return scan(code, pos, digitBlock, isDigit); }
+		inline uint64_t skipNameChars(const std::string& code, uint64_t pos) { return scan(code, pos, nameCharBlock, isNameChar); }
+		inline uint64_t findLineEnd(const std::string& code, uint64_t pos) { return scan(code, pos, notNewlineBlock, isNotNewline); }
+	#else
+		template <typename Pred>
+		uint64_t scan(const std::string& code, uint64_t pos, Pred pred)
+		{
+			while (pred(code[pos]))
+				++pos;
+			return pos;
+		}
+
+		inline uint64_t skipBlanks(const std::string& code, uint64_t pos) { return scan(code, pos, isBlank); }
+		inline uint64_t skipDigits(const std::string& code, uint64_t pos) { return scan(code, pos, isDigit); }
+		inline uint64_t skipNameChars(const std::string& code, uint64_t pos) { return scan(code, pos, isNameChar); }
+		inline uint64_t findLineEnd(const std::string& code, uint64_t pos) { return scan(code, pos, isNotNewline); }
+	#endif
+	}
+}
@@ -10,7 +10,10 @@ namespace MarC
 	class AsmTokenizer
 	{
 	public:
+		// The code gets copied into the string store of the token list on every call to tokenize().
 		AsmTokenizer(const std::string& asmCode);
+		// Takes ownership of the code, the tokens point directly into it.
+		AsmTokenizer(std::string&& asmCode);
 	public:
 		bool tokenize();
 	public:
@@ -23,7 +26,9 @@ namespace MarC
 	public:
 		void recover();
 	private:
+		AsmStringStoreRef m_pStore;
 		const std::string& m_asmCode;
+		bool m_ownsCode;
 		AsmTokenListRef m_pTokenList;
 		AsmTokenizerError m_lastErr;
 		uint64_t m_nextCharToTokenize = 0;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <functional>
 #include "Memory.h"
 #include "ModuleInfo.h"
 #include "ModulePack.h"
@@ -10,11 +12,19 @@
 
 namespace MarC
 {
+	// Returns the assembled object of the requested module, nullptr if it can't be provided.
+	typedef std::function<ModuleInfoRef(const std::string& modName)> ObjectResolver;
+
 	class Assembler
 	{
 	public:
 		Assembler(const ModulePackRef modPack);
 	public:
+		// Assemble a relocatable object: '#reqmod' only imports the macros of the resolved object
+		// instead of assembling the dependency into this module.
+		void setObjectResolver(ObjectResolver resolver);
+		// Must be set before assembling, objects can only be linked with objects of the same encoding.
+		void setCodeEncoding(BC_CodeEncoding encoding);
 		bool assemble();
 	public:
 		ModuleInfoRef getModuleInfo();
@@ -51,6 +61,7 @@ namespace MarC
 		void assembleDirAlias();
 		void assembleDirStatic();
 		void assembleDirRequestModule();
+		void importObjectMacros(const std::string& modName);
 		void assembleDirExtension();
 		void assembleDirScope();
 		void assembleDirEnd();
@@ -75,11 +86,12 @@ namespace MarC
 		void addFuncScope(const std::string& name);
 		void removeScope();
 		std::string getScopedName(const std::string& name);
-		void addSymbolAlias(SymbolAlias symAlias);
+		SymbolID getScopedID(std::string_view name);
+		void addSymbolAlias(const std::string& name, std::string_view refName);
 	private:
-		bool macroExists(const std::string& macroName);
+		bool macroExists(std::string_view macroName);
 		void expandMacro(const std::string& macroName, const std::vector<AsmTokenList>& parameters);
-		void addMacro(const std::string& macroName, const Macro& macro);
+		void addMacro(const std::string& macroName, Macro&& macro);
 	private:
 		bool isInstruction();
 		bool isMacro();
@@ -99,20 +111,29 @@ namespace MarC
 		void pushCode(const T& data);
 		template <typename T>
 		void writeCode(const T& data, uint64_t offset);
+		// Pads the code with zeros up to the next multiple of 'alignment'.
+		void alignCode(uint64_t alignment);
+		BC_CodeEncoding codeEncoding() const;
 	private:
 		uint64_t currCodeOffset() const;
-		BC_MemAddress currCodeAddr() const;
+		// Address of the next instruction, pads the code to the instruction alignment.
+		BC_MemAddress currCodeAddr();
 		uint64_t currStaticStackOffset() const;
 		BC_MemAddress currStaticStackAddr() const;
 	private:
 		ModulePackRef m_pModPack;
 		AsmTokenListRef m_pCurrTokenList;
+		AsmStringStoreRef m_pStringStore; // Owns token values generated while assembling (e.g. pragma names)
 		AssemblerError m_lastErr;
 		ModuleInfoRef m_pModInfo;
 		std::vector<ScopeDesc> m_scopeList;
+		std::string m_scopePrefix = ">>"; // ">>scope>>scope>>" for the current m_scopeList
+		std::string m_scopedNameBuffer;
 		std::vector<AsmToken> m_pragmaList;
 		uint64_t m_nextPragmaIndex = 0;
+		std::string m_pragmaSuffix = "__";
 		std::set<std::string> m_resolvedDependencies;
+		ObjectResolver m_resolveObject;
 		uint64_t m_nextTokenToCompile = 0;
 		uint64_t m_backupNextTokenToCompile = 0;
 	private:
@@ -146,6 +167,7 @@ namespace MarC
 			DelayedPush(Assembler& assembler, T* pObj, bool destroyObjOnDestruct)
 				: m_asm(assembler), m_pObj(pObj), m_destroyObjOnDestruct(destroyObjOnDestruct)
 			{
+				assembler.alignCode(BC_OperandAlignment(assembler.codeEncoding(), sizeof(T)));
 				m_codeOffset = assembler.currCodeOffset();
 				m_asm.pushCode(*m_pObj);
 			}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "Memory.h"
+#include "types/DisAsmTypes.h"
+
+namespace MarC
+{
+	struct CodeInstruction
+	{
+		uint64_t offset = 0; // Offset of the instruction within the code memory.
+		DisAsmInsInfo daii;
+	};
+
+	struct BasicBlock
+	{
+		uint64_t begin = 0; // Index of the first instruction.
+		uint64_t end = 0; // Index past the last instruction.
+		std::vector<uint64_t> successors;
+		std::vector<uint64_t> predecessors;
+		bool addressTaken = false; // The block's address is used as a value, it can be entered through indirect jumps/calls.
+	};
+
+	// Basic blocks of linked bytecode and the control flow between them.
+	// Direct jumps/calls and fall-throughs (including the return from a call) are edges,
+	// indirect jumps/calls and writes to '$cp' can only enter address taken blocks.
+	class ControlFlowGraph
+	{
+	public:
+		ControlFlowGraph() = delete;
+		ControlFlowGraph(const std::vector<CodeInstruction>& code, uint64_t codeSize);
+	public:
+		const std::vector<BasicBlock>& getBlocks() const;
+		uint64_t blockOf(uint64_t insIndex) const;
+		// Blocks that can be reached from the start of the code or from any address taken block.
+		std::vector<bool> reachableBlocks() const;
+		// The distance between '$sp' and '$fp' in front of every instruction ('UnknownStackDepth' if it isn't statically known).
+		// Functions are expected to return with a balanced stack.
+		std::vector<int64_t> stackDepths(const std::vector<CodeInstruction>& code) const;
+	public:
+		static constexpr int64_t UnknownStackDepth = INT64_MAX;
+	public:
+		// Decodes the instructions of 'codeMemory'. Returns false (and the instructions in front of it) on an unknown instruction.
+		static bool decode(const Memory& codeMemory, BC_CodeEncoding encoding, std::vector<CodeInstruction>& code);
+		// Index of the instruction at 'codeAddr', 'code.size()' for the end of the code and -1 for anything else.
+		static uint64_t indexOf(const std::vector<CodeInstruction>& code, uint64_t codeSize, BC_MemAddress codeAddr);
+		static bool isJump(BC_OpCode oc);
+		static bool isConditionalJump(BC_OpCode oc);
+		// Whether the instruction doesn't (always) continue with the next one.
+		static bool isControlFlow(const DisAsmInsInfo& daii);
+		// Whether the argument is the target of a direct jump/call.
+		static bool isDirectTarget(const DisAsmInsInfo& daii, uint64_t argIndex);
+		// Whether the argument's value is an address (instead of a plain value or datatype).
+		static bool isAddressArg(const DisAsmArg& arg);
+		static bool isCodeAddressArg(const DisAsmArg& arg);
+		// Total size of the arguments passed by a 'call'.
+		static uint64_t callArgSize(const DisAsmInsInfo& daii);
+		// The stack depth behind the instruction, given the depth in front of it.
+		static int64_t applyStackEffect(const DisAsmInsInfo& daii, int64_t depth);
+	private:
+		uint64_t m_codeSize;
+		std::vector<BasicBlock> m_blocks;
+		std::vector<uint64_t> m_blockOf; // Instruction index -> block index
+	};
+}
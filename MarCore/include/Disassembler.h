@@ -1,5 +1,8 @@
 #pragma once
 
+#include <vector>
+
+#include "Memory.h"
 #include "types/DisAsmTypes.h"
 
 namespace MarC
@@ -11,17 +14,29 @@ namespace MarC
 		{
 		public:
 			InstructionParser() = delete;
-			InstructionParser(const void* pInstruction);
+			InstructionParser(const void* pInstruction, BC_CodeEncoding encoding);
 		public:
 			template <typename T>
 			const T& read();
+			// Skips the padding in front of an operand of 'size' bytes.
+			void align(uint64_t size);
+			BC_MemAddress readAddress();
 			uint64_t insSize() const;
 		private:
 			const void* m_pInsOrig;
 			const void* m_pIns;
+			BC_CodeEncoding m_encoding;
 		};
 	public:
-		static DisAsmInsInfo disassemble(const void* pInstruction);
+		// Upper bound of the size of a single instruction (call with eight arguments).
+		static constexpr uint64_t MaxInstructionSize = 256;
+	public:
+		static DisAsmInsInfo disassemble(const void* pInstruction, BC_CodeEncoding encoding = BC_CodeEncoding::Packed);
+		// Copy of the code with the zeroed headroom disassembleChecked() needs behind it.
+		static std::vector<char> paddedCode(const Memory& codeMemory);
+		// Disassembles the instruction at 'offset' (< 'codeSize') of padded code, after checking everything disassemble()
+		// uses as a table index or loop count. 'daii' is only valid if the result is DisAsmCheck::Ok.
+		static DisAsmCheck disassembleChecked(const std::vector<char>& code, uint64_t codeSize, uint64_t offset, BC_CodeEncoding encoding, DisAsmInsInfo& daii);
 	private:
 		static void disassembleArgument(DisAsmInsInfo& daii, InstructionParser& ip, const InsArgument& arg);
 		static DisAsmArg disassembleArgValue(DisAsmInsInfo& daii, InstructionParser& ip, const InsArgument& arg);
@@ -33,6 +48,7 @@ namespace MarC
 	template <typename T>
 	const T& Disassembler::InstructionParser::read()
 	{
+		align(sizeof(T));
 		const T& temp = *(const T*)m_pIns;
 		m_pIns = (char*)m_pIns + sizeof(T);
 		return temp;
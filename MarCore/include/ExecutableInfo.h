@@ -14,6 +14,7 @@ namespace MarC
 	struct ExecutableInfo
 	{
 		std::string name = "<unnamed>";
+		BC_CodeEncoding codeEncoding = BC_CodeEncoding::Packed;
 		Memory codeMemory;
 		Memory staticStack;
 		std::set<std::string> mandatoryPermissions;
@@ -27,6 +28,7 @@ namespace MarC
 	struct ExeInfoHeader
 	{
 		uint64_t nSymbols;
+		uint64_t codeEncoding; // BC_CodeEncoding
 	};
 	MARC_SERIALIZER_ENABLE_FIXED(ExeInfoHeader);
 
@@ -35,6 +37,7 @@ namespace MarC
 	{
 		ExeInfoHeader header;
 		header.nSymbols = exeInfo.symbols.size();
+		header.codeEncoding = (uint64_t)exeInfo.codeEncoding;
 
 		serialize(header, oStream);
 
@@ -56,6 +59,7 @@ namespace MarC
 
 		ExeInfoHeader header;
 		deserialize(header, iStream);
+		exeInfo.codeEncoding = (BC_CodeEncoding)header.codeEncoding;
 
 		deserialize(exeInfo.name, iStream);
 		deserialize(exeInfo.codeMemory, iStream);
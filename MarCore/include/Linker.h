@@ -1,6 +1,7 @@
 #pragma once
 
 #include <set>
+#include <map>
 
 #include "ModuleInfo.h"
 #include "errors/LinkerError.h"
@@ -16,11 +17,15 @@ namespace MarC
 	public:
 		Linker() = delete;
 		Linker(ModuleInfoRef modInfo);
+		// Combines relocatable objects into one module. The last object is the entry module,
+		// the code of every other object is placed where it got requested first (like '#reqmod' splices modules when assembling in one piece).
+		Linker(const std::vector<ModuleInfoRef>& objects);
 	public:
 		bool link();
 	public:
 		ExecutableInfoRef getExeInfo();
 	private:
+		void addObject(const ModuleInfo& object, const std::map<std::string, const ModuleInfo*>& objects, std::set<std::string>& placed);
 		void resolveSymbolAliases();
 		void resolveUnresolvedSymbolRefs();
 	private:
@@ -30,6 +35,9 @@ namespace MarC
 		void resetError();
 	private:
 		ModuleInfoRef m_modInfo;
+		std::string m_missingObject; // Name of the first required module without an object.
+		std::string m_encodingMismatch; // Name of the first object whose encoding differs from the previous ones.
+		std::string m_compactOverflow; // First relocated address that doesn't fit its compact operand.
 		LinkerError m_lastErr;
 	};
 }
\ No newline at end of file
@@ -5,10 +5,16 @@
 #include "Assembler.h"
 #include "Linker.h"
 #include "Disassembler.h"
+#include "ControlFlowGraph.h"
+#include "Optimizer.h"
+#include "Verifier.h"
 
 #include "fileio/ModuleLocator.h"
 #include "fileio/ModuleLoader.h"
 #include "fileio/ExecutableLoader.h"
+#include "fileio/ObjectLoader.h"
+#include "fileio/BuildCache.h"
+#include "fileio/FileIndex.h"
 #include "fileio/CodeFileReader.h"
 
 #include "runtime/Interpreter.h"
\ No newline at end of file
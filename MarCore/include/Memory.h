@@ -32,6 +32,8 @@ namespace MarC
 		bool autoResize(uint64_t newSize);
 		bool resizable() const;
 		void resizable(bool state);
+		// Releases the excess capacity left by the geometric growth.
+		void shrinkToFit();
 	public:
 		void* getBaseAddress();
 		const void* getBaseAddress() const;
@@ -39,6 +41,8 @@ namespace MarC
 	public:
 		static MemoryRef create();
 		static MemoryRef create(uint64_t initSize, bool resizable = true);
+	private:
+		static uint64_t paddedSize(uint64_t size);
 	private:
 		std::vector<char> m_data;
 		bool m_resizable;
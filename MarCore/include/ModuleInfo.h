@@ -13,11 +13,23 @@ namespace MarC
 	{
 	public:
 		ExecutableInfoRef exeInfo;
+		SymbolNameTable symbolNames;
+		std::vector<const Symbol*> symbolsByID; // Definitions in exeInfo->symbols, nullptr while undefined
 		std::set<SymbolAlias> symbolAliases;
-		std::map<std::string, Macro> macros;
+		std::map<std::string, Macro, std::less<>> macros;
+		std::set<std::string, std::less<>> importedMacros; // Macros of required objects, not exported again
 		std::vector<SymbolRef> unresolvedSymbolRefs;
+		std::vector<uint64_t> codeRelocations; // Code offsets of addresses into this module's code memory or static stack
+		std::vector<std::string> requiredModules; // Modules requested via '#reqmod' when assembled as an object, in request order
+		std::vector<uint64_t> requiredModuleOffsets; // Code offset of each request, the linker places the required module's code there
+		uint64_t sourceHash = 0; // Identifies the inputs the object was assembled from (see ObjectLoader::sourceHash), 0 if unknown
+		uint64_t interfaceHash = 0; // Identifies the macros dependents import from the object (see ObjectLoader::interfaceHash)
 	public:
 		ModuleInfo();
+	public:
+		// Adds the symbol to exeInfo->symbols, the first definition of a name wins.
+		void defineSymbol(SymbolID id, const Symbol& symbol);
+		const Symbol* findSymbol(SymbolID id) const;
 	public:
 		void backup();
 		void recover();
@@ -30,4 +42,10 @@ namespace MarC
 			uint64_t unresSymRefSize = 0;
 		} bud;
 	};
+
+	// Relocatable object files (*.mco) are serialized ModuleInfos.
+	template <>
+	void serialize(const ModuleInfo& modInfo, std::ostream& oStream);
+	template <>
+	void deserialize(ModuleInfo& modInfo, std::istream& iStream);
 }
\ No newline at end of file
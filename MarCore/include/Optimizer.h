@@ -0,0 +1,109 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "ExecutableInfo.h"
+#include "ControlFlowGraph.h"
+
+namespace MarC
+{
+	struct OptimizerReport
+	{
+		uint64_t nInsBefore = 0;
+		uint64_t nInsAfter = 0;
+		uint64_t codeSizeBefore = 0;
+		uint64_t codeSizeAfter = 0;
+		uint64_t staticSizeBefore = 0;
+		uint64_t staticSizeAfter = 0;
+		std::map<std::string, uint64_t> rewrites; // Name of the rewrite -> number of times it has been applied
+		std::vector<std::string> inlinedCalls; // "'<function>' into <call site>"
+		std::string skipReason; // Set if the code couldn't be optimized at all.
+	};
+
+	std::string OptimizerReportToString(const OptimizerReport& report);
+
+	// Rewrites the bytecode of a linked executable in place.
+	// Level 0 leaves the code untouched, level 1 runs the peephole rewrites,
+	// level 2 additionally folds constant branches, turns tail calls into jumps and removes unreachable code and unused static data.
+	class Optimizer
+	{
+	public:
+		static constexpr uint64_t DefaultInlineLimit = 16;
+	public:
+		Optimizer() = delete;
+		Optimizer(ExecutableInfoRef exeInfo, uint64_t level = 1);
+	public:
+		// Inline calls of functions with at most 'maxInstructions' instructions (0 disables inlining, the default).
+		void setInlineLimit(uint64_t maxInstructions);
+		void optimize();
+		const OptimizerReport& getReport() const;
+	private:
+		struct InlineCandidate
+		{
+			bool inlinable = false;
+			uint64_t ret = 0; // Index of the 'return' ending the function.
+			uint64_t localSize = 0; // Bytes reserved by the function's 'pushn' prologue.
+			int64_t minFrameOffset = 0; // Range of the negative frame offsets used (return value).
+			int64_t maxFrameOffset = INT64_MIN;
+		};
+		// A code address of a new layout, patched once all offsets are known.
+		struct Fixup
+		{
+			uint64_t insIndex;
+			uint64_t argIndex;
+			uint64_t target;
+			bool isNewIndex; // Whether 'target' already is an index into the new code.
+		};
+		enum class TempAccess
+		{
+			None,
+			Read,
+			Write,
+		};
+	private:
+		bool decode();
+		void runPasses();
+		void collectTargets();
+		bool threadJumps();
+		bool removeJumpsToNext();
+		bool removeNoOps();
+		bool removeTempSaves();
+		bool foldConstantBranches();
+		bool removeUnreachableCode();
+		void removeUnusedStatics();
+		bool inlineCalls();
+		InlineCandidate analyzeInlineCandidate(uint64_t entry) const;
+		bool eliminateTailCalls();
+		bool isTailCall(uint64_t index, int64_t depth) const;
+		// Replaces the code with 'code', 'newIndex' maps old instruction indices to new ones.
+		void relayout(std::vector<CodeInstruction> code, const std::vector<uint64_t>& newIndex, const std::vector<Fixup>& fixups);
+		void compact();
+		void rebuild();
+	private:
+		uint64_t indexOf(BC_MemAddress codeAddr) const;
+		uint64_t nextLive(uint64_t index) const;
+		bool isTarget(uint64_t index) const;
+		BC_MemAddress codeAddrOf(uint64_t index) const;
+		void setArgValue(CodeInstruction& ins, uint64_t argIndex, BC_MemAddress addr);
+		void remove(uint64_t index, const std::string& rewrite);
+		void relocateCodeSymbols(const std::function<BC_MemAddress(BC_MemAddress)>& relocate);
+		void appendCopy(std::vector<CodeInstruction>& code, std::vector<Fixup>& fixups, const CodeInstruction& ins) const;
+		std::string describeCodeAddr(uint64_t offset) const;
+		TempAccess tempAccess(const CodeInstruction& ins) const;
+		bool tempDeadAfter(uint64_t index) const;
+	private:
+		ExecutableInfoRef m_exeInfo;
+		uint64_t m_level;
+		uint64_t m_inlineLimit = 0;
+		std::vector<CodeInstruction> m_code;
+		uint64_t m_codeSize = 0; // Offset of the end of the code.
+		std::vector<bool> m_removed;
+		std::set<uint64_t> m_unreachable; // Offsets of removed unreachable instructions, their symbols get dropped.
+		std::set<uint64_t> m_targets; // Indices of instructions that may be entered from somewhere else than their predecessor.
+		OptimizerReport m_report;
+	};
+}
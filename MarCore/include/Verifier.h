@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ExecutableInfo.h"
+#include "ControlFlowGraph.h"
+#include "errors/VerifierError.h"
+
+namespace MarC
+{
+	// Checks a linked executable once before it gets interpreted: instruction boundaries, opCodes, datatypes and deref counts,
+	// the constant addresses the code accesses or jumps to and, where it's statically known, the stack depth.
+	// Addresses only known at runtime (pointers, writes to '$cp', return addresses) are still trusted.
+	// Executables that pass can be interpreted unchecked (see Interpreter::setUnchecked).
+	class Verifier
+	{
+	public:
+		Verifier() = delete;
+		Verifier(ExecutableInfoRef exeInfo);
+	public:
+		bool verify();
+	private:
+		void decode();
+		void verifyInstruction(const CodeInstruction& ins) const;
+		void verifyArgument(const CodeInstruction& ins, uint64_t argIndex) const;
+		void verifyAccess(const CodeInstruction& ins, BC_MemAddress addr, bool isWrite) const;
+		void verifyExternalName(const CodeInstruction& ins, BC_MemAddress addr) const;
+		void verifyStackDepths() const;
+	private:
+		// Whether the instruction reads or writes the memory at the (non-dereferenced) address argument.
+		static bool accessesAddressArg(BC_OpCode oc, uint64_t argIndex);
+		std::string location(const CodeInstruction& ins) const;
+	public:
+		const VerifierError& lastError() const;
+		void resetError();
+	private:
+		ExecutableInfoRef m_exeInfo;
+		std::vector<CodeInstruction> m_code;
+		VerifierError m_lastErr;
+	};
+}
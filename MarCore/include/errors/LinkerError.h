@@ -17,6 +17,9 @@ namespace MarC
 			UnresolvedSymbols,
 			ModuleNotFound,
 			AmbigiousModule,
+			AliasCycle,
+			EncodingMismatch,
+			CompactAddressOverflow,
 		};
 	public:
 		LinkerError()
@@ -52,6 +55,15 @@ namespace MarC
 			case Code::AmbigiousModule:
 				message = "The module name '" + context + "' is ambigious!";
 				break;
+			case Code::AliasCycle:
+				message = "The following aliases form a cycle!:\n  " + context;
+				break;
+			case Code::EncodingMismatch:
+				message = "The object '" + context + "' uses a different code encoding than the objects before it!";
+				break;
+			case Code::CompactAddressOverflow:
+				message = "The address of '" + context + "' doesn't fit into a compact address operand!";
+				break;
 			default:
 				message = "Unknown error code! Context: " + context;
 			}
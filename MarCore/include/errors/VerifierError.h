@@ -0,0 +1,86 @@
+#pragma once
+
+#include "MarCoreError.h"
+
+namespace MarC
+{
+	class VerifierError : public MarCoreError
+	{
+	public:
+		enum class Code
+		{
+			Success = 0,
+			PlainContext,
+			InvalidEncoding,
+			TruncatedInstruction,
+			InvalidOpCode,
+			InvalidDatatype,
+			InvalidDerefCount,
+			InvalidAddress,
+			InvalidCodeAddress,
+			CodeWrite,
+			InvalidExternalName,
+			StackUnderflow,
+		};
+	public:
+		VerifierError()
+			: VerifierError(Code::Success, "")
+		{}
+		VerifierError(Code code, const std::string& context)
+			: MarCoreError("VerifierError"), m_code(code)
+		{
+			std::string message;
+			switch (m_code)
+			{
+			case Code::Success:
+				message = "Success";
+				break;
+			case Code::PlainContext:
+				message = context;
+				break;
+			case Code::InvalidEncoding:
+				message = "Unknown code encoding '" + context + "'!";
+				break;
+			case Code::TruncatedInstruction:
+				message = "The instruction at " + context + " exceeds the end of the code!";
+				break;
+			case Code::InvalidOpCode:
+				message = "Invalid opCode at " + context + "!";
+				break;
+			case Code::InvalidDatatype:
+				message = "Invalid datatype at " + context + "!";
+				break;
+			case Code::InvalidDerefCount:
+				message = "Invalid dereference count at " + context + "!";
+				break;
+			case Code::InvalidAddress:
+				message = "Access to an invalid address at " + context + "!";
+				break;
+			case Code::InvalidCodeAddress:
+				message = "Code address not pointing to an instruction at " + context + "!";
+				break;
+			case Code::CodeWrite:
+				message = "Write to the code memory at " + context + "!";
+				break;
+			case Code::InvalidExternalName:
+				message = "Invalid external function name at " + context + "!";
+				break;
+			case Code::StackUnderflow:
+				message = "The stack is popped past the frame at " + context + "!";
+				break;
+			default:
+				message = "Unknown error code! Context: " + context;
+			}
+
+			m_whatBuff = message;
+		}
+	public:
+		virtual explicit operator bool() const override { return m_code != Code::Success; }
+	public:
+		Code getCode() const { return m_code; }
+	private:
+		Code m_code;
+	};
+
+	typedef VerifierError::Code VerifErrCode;
+}
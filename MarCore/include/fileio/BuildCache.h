@@ -0,0 +1,57 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <functional>
+
+#include "ExecutableInfo.h"
+#include "ModuleInfo.h"
+
+namespace MarC
+{
+	typedef std::shared_ptr<class BuildCache> BuildCacheRef;
+
+	// On-disk cache for assembled and linked modules.
+	// Entries are addressed by the contents of a module and all modules it (transitively) requires,
+	// a cache hit skips tokenizing, assembling and linking.
+	class BuildCache
+	{
+	public:
+		// Bump whenever the assembler/linker output for unchanged sources changes.
+		static constexpr uint64_t FormatVersion = 2;
+	public:
+		struct Key
+		{
+			std::string material;
+			uint64_t hash = 0;
+		};
+	public:
+		// 'toolID' gets mixed into every key, hosts use it to invalidate entries created by other builds of themselves.
+		BuildCache(const std::string& cacheDir, const std::string& toolID = "");
+	public:
+		// 'kind' separates entries created from the same sources by different pipelines.
+		Key makeKey(const std::string& kind, const std::string& modPath, const std::set<std::string>& modDirs) const;
+
+		ExecutableInfoRef loadExecutable(const Key& key) const;
+		void storeExecutable(const Key& key, const ExecutableInfo& exeInfo) const;
+
+		bool loadBuild(const Key& key, ExecutableInfoRef& exeInfo, std::vector<ModuleInfoRef>& objects) const;
+		void storeBuild(const Key& key, const ExecutableInfo& exeInfo, const std::vector<ModuleInfoRef>& objects) const;
+	public:
+		const std::string& getCacheDir() const { return m_cacheDir; }
+	public:
+		// $MARC_CACHE_DIR if set, a directory in the system's temp directory otherwise.
+		static std::string defaultDir();
+		static BuildCacheRef create(const std::string& cacheDir, const std::string& toolID = "");
+	private:
+		std::string entryPath(const Key& key) const;
+		bool openEntry(const Key& key, std::ifstream& iStream) const;
+		void writeEntry(const Key& key, const std::function<void(std::ostream&)>& writePayload) const;
+	private:
+		std::string m_cacheDir;
+		std::string m_toolID;
+	};
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace MarC
+{
+	typedef std::shared_ptr<const class FileIndex> FileIndexRef;
+
+	// Index of all module/object/extension files below a directory, built with a single recursive scan.
+	// Indices are built once per process and shared by everything that locates files (ModuleLoader, ObjectLoader, Interpreter, ...).
+	class FileIndex
+	{
+	public:
+		FileIndex(const std::string& baseDir);
+	public:
+		// Absolute paths of all indexed files named '<stem><extension>', nullptr if there are none.
+		const std::set<std::string>* find(const std::string& extension, const std::string& stem) const;
+	public:
+		// Returns the shared index of 'baseDir', building (or loading a persisted) one on first use.
+		static FileIndexRef get(const std::string& baseDir);
+		// Persists indices in 'dir' and reuses them in later processes as long as no indexed directory has been modified.
+		// An empty string (the default) disables persisting.
+		static void setPersistDir(const std::string& dir);
+		// Drops all shared indices, the next lookup rescans the directories.
+		static void invalidate();
+		static bool isIndexed(const std::string& extension);
+	private:
+		void scan();
+		void addFile(const std::string& path);
+		std::string persistPath(const std::string& persistDir) const;
+		bool loadPersisted(const std::string& persistDir);
+		void persist(const std::string& persistDir) const;
+	private:
+		std::string m_baseDir;
+		std::map<std::string, std::map<std::string, std::set<std::string>>> m_files; // extension -> stem -> paths
+		std::vector<std::pair<std::string, int64_t>> m_dirTimes; // Every indexed directory with its last write time.
+	private:
+		static std::mutex s_mtx;
+		static std::map<std::string, FileIndexRef> s_indices;
+		static std::string s_persistDir;
+	};
+}
@@ -7,5 +7,5 @@
 
 namespace MarC
 {
-	std::map<std::string, std::set<std::string>> locateModules(const std::set<std::string>& baseDirs, const std::set<std::string>& modNames);
+	std::map<std::string, std::set<std::string>> locateModules(const std::set<std::string>& baseDirs, const std::set<std::string>& modNames, const std::string& extension = ".mca");
 }
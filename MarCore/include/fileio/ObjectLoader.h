@@ -0,0 +1,27 @@
+#pragma once
+
+#include <set>
+#include <vector>
+
+#include "ModuleInfo.h"
+#include "types/AsmTokenizerTypes.h"
+
+namespace MarC
+{
+	class ObjectLoader
+	{
+	public:
+		static ModuleInfoRef load(const std::string& objPath);
+		static void save(const ModuleInfo& object, const std::string& objPath);
+		// Loads the object and the objects of all modules it requires (searched for in its own directory and 'modDirs').
+		// Dependencies come before their dependents, the object at 'objPath' comes last.
+		static std::vector<ModuleInfoRef> loadWithDependencies(const std::string& objPath, const std::set<std::string>& modDirs);
+	public:
+		// Identifies the inputs of an object: the module's tokens, the code encoding and the interfaces of the objects it requires.
+		// Objects whose hash still matches don't have to be assembled again.
+		static uint64_t sourceHash(const AsmTokenList& tokenList, BC_CodeEncoding encoding, const std::vector<ModuleInfoRef>& requiredObjects);
+		// Identifies what dependents import from an object: its own macros and (indirectly) the ones of the objects it requires.
+		// Changing only the code of a module keeps the interface, its dependents are still up to date.
+		static uint64_t interfaceHash(const ModuleInfo& object, const std::vector<ModuleInfoRef>& requiredObjects);
+	};
+}
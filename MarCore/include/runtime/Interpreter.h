@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstring>
+#include <cstdlib>
+#include <type_traits>
 
 #include "types/BytecodeTypes.h"
 #include "unused.h"
@@ -10,8 +12,17 @@
 
 #include "SearchAlgorithms.h"
 #include "ExternalFunction.h"
+#include "InterpreterObserver.h"
 #include "errors/InterpreterError.h"
 
+// The dispatch loop gets instantiated once per code encoding. Its hottest helpers have to be inlined into every instantiation,
+// the compiler's unit growth limit would otherwise leave them as calls in whichever loop it happens to process last.
+#if defined(_MSC_VER)
+	#define MARC_INTERPRETER_INLINE __forceinline
+#else
+	#define MARC_INTERPRETER_INLINE inline __attribute__((always_inline))
+#endif
+
 namespace MarC
 {
 	typedef std::shared_ptr<class Interpreter> InterpreterRef;
@@ -23,7 +34,15 @@ namespace MarC
 	public:
 		void addExtDir(const std::string& path);
 	public:
+		// Loads all required extensions and binds every external function called by a constant name,
+		// interpreting doesn't hit the file system or the plugin manager for them anymore. Call after granting permissions,
+		// functions without a granted permission stay unbound. Returns false on failure, see lastError().
+		bool prepare();
+		// Drops the per-instruction end of code check, the code ends at a zeroed 'BC_OC_NONE' sentinel instead.
+		// Only for executables that passed the Verifier and don't change anymore. Observed runs keep the check.
+		void setUnchecked(bool unchecked);
 		bool interpret(uint64_t nInstructinos = RunTillEOC);
+		template <class Observer> bool interpret(uint64_t nInstructions, Observer& observer);
 	public:
 		bool isGrantedPerm(const std::string& name) const;
 		bool hasUngrantedPerms() const;
@@ -52,42 +71,52 @@ namespace MarC
 		void initMemory(uint64_t dynStackSize);
 		void recalcExeMem();
 		void loadMissingExtensions();
-		template <typename T> T& readDataAndMove();
-		template <typename T> T& readDataAndMove(uint64_t shift);
-		BC_MemCell& readMemCellAndMove(BC_Datatype dt, DerefCount dc);
+		void bindExternalFunction(BC_MemAddress funcAddr);
+		// Picks the instantiation of run() for the encoding of the code.
+		template <bool CheckEndOfCode, class Observer> void runEncoded(uint64_t nInstructions, Observer& observer);
+		// Executes up to 'nInstructions' instructions of code in 'Encoding', every encoding has its own instantiation.
+		template <BC_CodeEncoding Encoding, bool CheckEndOfCode, class Observer> void run(uint64_t nInstructions, Observer& observer);
+		template <BC_CodeEncoding Encoding, typename T> T& readDataAndMove();
+		template <BC_CodeEncoding Encoding, typename T> T& readDataAndMove(uint64_t shift);
+		// Skips the padding of aligned code, 'mask' is the alignment - 1.
+		void alignCodePointer(uint64_t mask);
+		template <BC_CodeEncoding Encoding> BC_MemAddress readAddressAndMove();
+		template <BC_CodeEncoding Encoding> BC_MemCell& readMemCellAndMove(BC_Datatype dt, DerefCount dc);
 	private:
 		void exec_insUndefined(BC_OpCodeEx ocx);
-		void exec_insMove(BC_OpCodeEx ocx);
-		void exec_insAdd(BC_OpCodeEx ocx);
-		void exec_insSubtract(BC_OpCodeEx ocx);
-		void exec_insMultiply(BC_OpCodeEx ocx);
-		void exec_insDivide(BC_OpCodeEx ocx);
-		void exec_insIncrement(BC_OpCodeEx ocx);
-		void exec_insDecrement(BC_OpCodeEx ocx);
-		void exec_insSetAddressBase(BC_OpCodeEx ocx);
-		void exec_insConvert(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insMove(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insAdd(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insSubtract(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insMultiply(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insDivide(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insIncrement(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insDecrement(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insSetAddressBase(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insConvert(BC_OpCodeEx ocx);
 		void exec_insPush(BC_OpCodeEx ocx);
 		void exec_insPop(BC_OpCodeEx ocx);
-		void exec_insPushNBytes(BC_OpCodeEx ocx);
-		void exec_insPopNBytes(BC_OpCodeEx ocx);
-		void exec_insPushCopy(BC_OpCodeEx ocx);
-		void exec_insPopCopy(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insPushNBytes(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insPopNBytes(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insPushCopy(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insPopCopy(BC_OpCodeEx ocx);
 		void exec_insPushFrame(BC_OpCodeEx ocx);
 		void exec_insPopFrame(BC_OpCodeEx ocx);
-		void exec_insJump(BC_OpCodeEx ocx);
-		void exec_insJumpEqual(BC_OpCodeEx ocx);
-		void exec_insJumpNotEqual(BC_OpCodeEx ocx);
-		void exec_insJumpLessThan(BC_OpCodeEx ocx);
-		void exec_insJumpGreaterThan(BC_OpCodeEx ocx);
-		void exec_insJumpLessEqual(BC_OpCodeEx ocx);
-		void exec_insJumpGreaterEqual(BC_OpCodeEx ocx);
-		void exec_insAllocate(BC_OpCodeEx ocx);
-		void exec_insFree(BC_OpCodeEx ocx);
-		void exec_insCallExtern(BC_OpCodeEx ocx);
-		void exec_insCall(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insJump(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insJumpEqual(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insJumpNotEqual(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insJumpLessThan(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insJumpGreaterThan(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insJumpLessEqual(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding> void exec_insJumpGreaterEqual(BC_OpCodeEx ocx);
+		template <BC_CodeEncoding Encoding, class Observer> void exec_insAllocate(BC_OpCodeEx ocx, Observer& observer);
+		template <BC_CodeEncoding Encoding, class Observer> void exec_insFree(BC_OpCodeEx ocx, Observer& observer);
+		template <BC_CodeEncoding Encoding, class Observer> void exec_insCallExtern(BC_OpCodeEx ocx, Observer& observer);
+		template <BC_CodeEncoding Encoding> void exec_insCall(BC_OpCodeEx ocx);
 		void exec_insReturn(BC_OpCodeEx ocx);
 		void exec_insExit(BC_OpCodeEx ocx);
 	private:
+		// The registers are packed, their address bitfields get read byte by byte in place. The helpers below and
+		// reachedEndOfCode() work on copies of '$sp', '$fp' and '$cp' instead.
 		void virt_pushStack(uint64_t nBytes);
 		void virt_pushStack(const BC_MemCell& mc, uint64_t nBytes);
 		void virt_popStack(uint64_t nBytes);
@@ -112,8 +141,130 @@ namespace MarC
 		std::set<std::string> m_extDirs;
 		InterpreterError m_lastErr;
 		uint64_t m_nInsExecuted = 0;
+		bool m_unchecked = false;
+		Memory m_sentinelCode; // Copy of the code memory for unchecked runs, followed by the sentinel.
 	};
 
+	template <class Observer> bool Interpreter::interpret(uint64_t nInstructions, Observer& observer)
+	{
+		resetError();
+
+		recalcExeMem();
+		
+		try
+		{
+			if constexpr (std::is_same_v<Observer, NullObserver>)
+			{
+				if (m_unchecked)
+					runEncoded<false>(nInstructions, observer);
+				else
+					runEncoded<true>(nInstructions, observer);
+			}
+			else
+			{
+				runEncoded<true>(nInstructions, observer);
+			}
+		}
+		catch (const InterpreterError& ie)
+		{
+			m_lastErr = ie;
+		}
+
+		return !lastError();
+	}
+
+	template <bool CheckEndOfCode, class Observer> void Interpreter::runEncoded(uint64_t nInstructions, Observer& observer)
+	{
+		switch (m_pExeInfo->codeEncoding)
+		{
+		case BC_CodeEncoding::Packed: run<BC_CodeEncoding::Packed, CheckEndOfCode>(nInstructions, observer); break;
+		case BC_CodeEncoding::Aligned: run<BC_CodeEncoding::Aligned, CheckEndOfCode>(nInstructions, observer); break;
+		case BC_CodeEncoding::Compact: run<BC_CodeEncoding::Compact, CheckEndOfCode>(nInstructions, observer); break;
+		}
+	}
+
+	template <BC_CodeEncoding Encoding, bool CheckEndOfCode, class Observer> void Interpreter::run(uint64_t nInstructions, Observer& observer)
+	{
+		while (nInstructions--)
+		{
+			if constexpr (CheckEndOfCode)
+			{
+				if (reachedEndOfCode())
+					throw InterpreterError(IntErrCode::AbortViaEndOfCode, "EOC");
+			}
+
+			uint64_t dynStackSize = m_mem.dynamicStack.size();
+
+			const auto& ocx = readDataAndMove<Encoding, BC_OpCodeEx>();
+
+			observer.beforeInstruction(*this, ocx);
+
+			switch (ocx.opCode)
+			{
+			case BC_OC_NONE:  exec_insUndefined(ocx); break;
+			case BC_OC_UNKNOWN: exec_insUndefined(ocx); break;
+
+			case BC_OC_MOVE: exec_insMove<Encoding>(ocx); break;
+			case BC_OC_ADD: exec_insAdd<Encoding>(ocx); break;
+			case BC_OC_SUBTRACT: exec_insSubtract<Encoding>(ocx); break;
+			case BC_OC_MULTIPLY: exec_insMultiply<Encoding>(ocx); break;
+			case BC_OC_DIVIDE: exec_insDivide<Encoding>(ocx); break;
+			case BC_OC_INCREMENT: exec_insIncrement<Encoding>(ocx); break;
+			case BC_OC_DECREMENT: exec_insDecrement<Encoding>(ocx); break;
+			case BC_OC_SET_ADDRESS_BASE: exec_insSetAddressBase<Encoding>(ocx); break;
+
+			case BC_OC_CONVERT: exec_insConvert<Encoding>(ocx); break;
+
+			case BC_OC_PUSH: exec_insPush(ocx); break;
+			case BC_OC_POP: exec_insPop(ocx); break;
+			case BC_OC_PUSH_N_BYTES: exec_insPushNBytes<Encoding>(ocx); break;
+			case BC_OC_POP_N_BYTES: exec_insPopNBytes<Encoding>(ocx); break;
+			case BC_OC_PUSH_COPY: exec_insPushCopy<Encoding>(ocx); break;
+			case BC_OC_POP_COPY: exec_insPopCopy<Encoding>(ocx); break;
+
+			case BC_OC_PUSH_FRAME: exec_insPushFrame(ocx); break;
+			case BC_OC_POP_FRAME: exec_insPopFrame(ocx); break;
+
+			case BC_OC_JUMP: exec_insJump<Encoding>(ocx); break;
+			case BC_OC_JUMP_EQUAL: exec_insJumpEqual<Encoding>(ocx); break;
+			case BC_OC_JUMP_NOT_EQUAL: exec_insJumpNotEqual<Encoding>(ocx); break;
+			case BC_OC_JUMP_LESS_THAN: exec_insJumpLessThan<Encoding>(ocx); break;
+			case BC_OC_JUMP_GREATER_THAN: exec_insJumpGreaterThan<Encoding>(ocx); break;
+			case BC_OC_JUMP_LESS_EQUAL: exec_insJumpLessEqual<Encoding>(ocx); break;
+			case BC_OC_JUMP_GREATER_EQUAL: exec_insJumpGreaterEqual<Encoding>(ocx); break;
+
+			case BC_OC_ALLOCATE: exec_insAllocate<Encoding>(ocx, observer); break;
+			case BC_OC_FREE: exec_insFree<Encoding>(ocx, observer); break;
+
+			case BC_OC_CALL_EXTERN: exec_insCallExtern<Encoding>(ocx, observer); break;
+
+			case BC_OC_CALL:
+				exec_insCall<Encoding>(ocx);
+				observer.onCall(*this, getRegister(BC_MEM_REG_CODE_POINTER).as_ADDR);
+				break;
+			case BC_OC_RETURN:
+				exec_insReturn(ocx);
+				observer.onReturn(*this, getRegister(BC_MEM_REG_CODE_POINTER).as_ADDR);
+				break;
+
+			case BC_OC_EXIT: exec_insExit(ocx); break;
+			default:
+				exec_insUndefined(ocx);
+			}
+
+			// '$cp' stays at instruction boundaries between instructions (return addresses point behind the call's operands).
+			if constexpr (Encoding == BC_CodeEncoding::Aligned)
+				alignCodePointer(BC_InstructionAlignment(Encoding) - 1);
+
+			if (dynStackSize != m_mem.dynamicStack.size())
+				observer.onStackGrowth(*this, m_mem.dynamicStack.size());
+
+			observer.afterInstruction(*this, ocx);
+
+			++m_nInsExecuted;
+		}
+	}
+
 	template <typename T> inline T& Interpreter::hostObject(BC_MemAddress clientAddr)
 	{
 		return *(T*)hostAddress(clientAddr);
@@ -124,47 +275,70 @@ namespace MarC
 		return *(T*)hostAddress(clientAddr, dc);
 	}
 
-	template <typename T> inline T& Interpreter::readDataAndMove()
+	template <BC_CodeEncoding Encoding, typename T> MARC_INTERPRETER_INLINE T& Interpreter::readDataAndMove()
 	{
-		return readDataAndMove<T>(sizeof(T));
+		return readDataAndMove<Encoding, T>(sizeof(T));
 	}
 
-	template <typename T> inline T& Interpreter::readDataAndMove(uint64_t shift)
+	template <BC_CodeEncoding Encoding, typename T> MARC_INTERPRETER_INLINE T& Interpreter::readDataAndMove(uint64_t shift)
 	{
+		if constexpr (Encoding == BC_CodeEncoding::Aligned)
+			alignCodePointer(BC_OperandAlignment(Encoding, shift) - 1);
 		return*(T*)hostAddress((getRegister(BC_MEM_REG_CODE_POINTER).as_ADDR += shift) - shift);
 	}
 
+	MARC_INTERPRETER_INLINE void Interpreter::alignCodePointer(uint64_t mask)
+	{
+		auto& cp = getRegister(BC_MEM_REG_CODE_POINTER).as_ADDR;
+		cp._raw = (cp._raw + mask) & ~mask;
+	}
+
+	template <BC_CodeEncoding Encoding> MARC_INTERPRETER_INLINE BC_MemAddress Interpreter::readAddressAndMove()
+	{
+		if constexpr (Encoding == BC_CodeEncoding::Compact)
+		{
+			auto& cp = getRegister(BC_MEM_REG_CODE_POINTER).as_ADDR;
+			const void* pAddr = hostAddress(cp);
+			cp.addr += BC_CompactAddressSize(*(const uint8_t*)pAddr);
+			return BC_ReadCompactAddress(pAddr);
+		}
+		else
+		{
+			return readDataAndMove<Encoding, BC_MemAddress>();
+		}
+	}
+
 	inline void* Interpreter::getExternalAddress(BC_MemAddress exAddr)
 	{
 		auto&[addr, base] = findGreatestSmaller(exAddr, m_mem.dynMemMap);
 		return (char*)base + (exAddr.addr - addr.addr);
 	}
 
-	inline void* Interpreter::hostAddress(BC_MemAddress clientAddr)
+	MARC_INTERPRETER_INLINE void* Interpreter::hostAddress(BC_MemAddress clientAddr)
 	{
 		return (clientAddr.base == BC_MEM_BASE_EXTERN) ?
 			getExternalAddress(clientAddr) :
 			(char*)m_mem.baseTable[clientAddr.base] + clientAddr.addr;
 	}
 
-	inline void* Interpreter::hostAddress(BC_MemAddress clientAddr, DerefCount dc)
+	MARC_INTERPRETER_INLINE void* Interpreter::hostAddress(BC_MemAddress clientAddr, DerefCount dc)
 	{
 		while (dc-- > 0)
 			clientAddr = *(BC_MemAddress*)hostAddress(clientAddr);
 		return hostAddress(clientAddr);
 	}
 
-	inline BC_MemCell& Interpreter::hostMemCell(BC_MemAddress clientAddr)
+	MARC_INTERPRETER_INLINE BC_MemCell& Interpreter::hostMemCell(BC_MemAddress clientAddr)
 	{
 		return hostObject<BC_MemCell>(clientAddr);
 	}
 
-	inline BC_MemCell& Interpreter::hostMemCell(BC_MemAddress clientAddr, DerefCount dc)
+	MARC_INTERPRETER_INLINE BC_MemCell& Interpreter::hostMemCell(BC_MemAddress clientAddr, DerefCount dc)
 	{
 		return hostObject<BC_MemCell>(clientAddr, dc);
 	}
 
-	inline BC_MemCell& Interpreter::getRegister(BC_MemRegister reg)
+	MARC_INTERPRETER_INLINE BC_MemCell& Interpreter::getRegister(BC_MemRegister reg)
 	{
 		return *(BC_MemCell*)((char*)&m_mem.registers + reg);
 	}
@@ -184,9 +358,27 @@ namespace MarC
 		return m_nInsExecuted;
 	}
 
-	inline BC_MemCell& Interpreter::readMemCellAndMove(BC_Datatype dt, DerefCount dc)
+	template <BC_CodeEncoding Encoding> MARC_INTERPRETER_INLINE BC_MemCell& Interpreter::readMemCellAndMove(BC_Datatype dt, DerefCount dc)
 	{
-		void* pmc = &readDataAndMove<BC_MemCell>(BC_DatatypeSize(dc ? BC_DT_ADDR : dt));
+		void* pmc;
+		if constexpr (Encoding == BC_CodeEncoding::Compact)
+		{
+			// Address operands get decoded into a cell of their own.
+			if (dc || dt == BC_DT_ADDR)
+			{
+				auto& cell = m_mem.compactOperands[m_mem.nextCompactOperand++ & 3];
+				cell.as_ADDR = readAddressAndMove<Encoding>();
+				pmc = &cell;
+			}
+			else
+			{
+				pmc = &readDataAndMove<Encoding, BC_MemCell>(BC_DatatypeSize(dt));
+			}
+		}
+		else
+		{
+			pmc = &readDataAndMove<Encoding, BC_MemCell>(BC_DatatypeSize(dc ? BC_DT_ADDR : dt));
+		}
 
 		while (dc-- > 0)
 			pmc = &hostMemCell(*(BC_MemAddress*)pmc);
@@ -194,63 +386,63 @@ namespace MarC
 		return *(BC_MemCell*)pmc;
 	}
 
-	inline void Interpreter::exec_insMove(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> MARC_INTERPRETER_INLINE void Interpreter::exec_insMove(BC_OpCodeEx ocx)
 	{
-		void* dest = hostAddress(readDataAndMove<BC_MemAddress>(), ocx.derefArg[0]);
-		const void* src = &readMemCellAndMove(ocx.datatype, ocx.derefArg[1]);
+		void* dest = hostAddress(readAddressAndMove<Encoding>(), ocx.derefArg[0]);
+		const void* src = &readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[1]);
 		memcpy(dest, src, BC_DatatypeSize(ocx.datatype));
 	}
-	inline void Interpreter::exec_insPush(BC_OpCodeEx ocx)
+	MARC_INTERPRETER_INLINE void Interpreter::exec_insPush(BC_OpCodeEx ocx)
 	{
 		virt_pushStack(BC_DatatypeSize(ocx.datatype));
 	}
-	inline void Interpreter::exec_insPop(BC_OpCodeEx ocx)
+	MARC_INTERPRETER_INLINE void Interpreter::exec_insPop(BC_OpCodeEx ocx)
 	{
 		virt_popStack(BC_DatatypeSize(ocx.datatype));
 	}
-	inline void Interpreter::exec_insPushNBytes(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> inline void Interpreter::exec_insPushNBytes(BC_OpCodeEx ocx)
 	{
-		virt_pushStack(readMemCellAndMove(BC_DT_U_64, ocx.derefArg[0]).as_U_64);
+		virt_pushStack(readMemCellAndMove<Encoding>(BC_DT_U_64, ocx.derefArg[0]).as_U_64);
 	}
-	inline void Interpreter::exec_insPopNBytes(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> inline void Interpreter::exec_insPopNBytes(BC_OpCodeEx ocx)
 	{
-		virt_popStack(readMemCellAndMove(BC_DT_U_64, ocx.derefArg[0]).as_U_64);
+		virt_popStack(readMemCellAndMove<Encoding>(BC_DT_U_64, ocx.derefArg[0]).as_U_64);
 	}
-	inline void Interpreter::exec_insPushCopy(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> MARC_INTERPRETER_INLINE void Interpreter::exec_insPushCopy(BC_OpCodeEx ocx)
 	{
 		virt_pushStack(
-			readMemCellAndMove(ocx.datatype, ocx.derefArg[0]),
+			readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[0]),
 			BC_DatatypeSize(ocx.datatype)
 		);
 	}
-	inline void Interpreter::exec_insPopCopy(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> MARC_INTERPRETER_INLINE void Interpreter::exec_insPopCopy(BC_OpCodeEx ocx)
 	{
 		virt_popStack(
-			hostMemCell(readDataAndMove<BC_MemAddress>(), ocx.derefArg[0]),
+			hostMemCell(readAddressAndMove<Encoding>(), ocx.derefArg[0]),
 			BC_DatatypeSize(ocx.datatype)
 		);
 	}
-	inline void Interpreter::exec_insPushFrame(BC_OpCodeEx ocx)
+	MARC_INTERPRETER_INLINE void Interpreter::exec_insPushFrame(BC_OpCodeEx ocx)
 	{
 		UNUSED(ocx);
 		virt_pushFrame();
 	}
-	inline void Interpreter::exec_insPopFrame(BC_OpCodeEx ocx)
+	MARC_INTERPRETER_INLINE void Interpreter::exec_insPopFrame(BC_OpCodeEx ocx)
 	{
 		UNUSED(ocx);
 		virt_popFrame();
 	}
-	inline void Interpreter::exec_insConvert(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> inline void Interpreter::exec_insConvert(BC_OpCodeEx ocx)
 	{
-		auto& mc = hostMemCell(readDataAndMove<BC_MemAddress>(), ocx.derefArg[0]);
-		auto dt = readDataAndMove<BC_Datatype>();
+		auto& mc = hostMemCell(readAddressAndMove<Encoding>(), ocx.derefArg[0]);
+		auto dt = readDataAndMove<Encoding, BC_Datatype>();
 		ConvertInPlace(mc, dt, ocx.datatype);
 	}
-	inline void Interpreter::exec_insJump(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> MARC_INTERPRETER_INLINE void Interpreter::exec_insJump(BC_OpCodeEx ocx)
 	{
-		getRegister(BC_MEM_REG_CODE_POINTER) = readMemCellAndMove(BC_DT_ADDR, ocx.derefArg[0]);
+		getRegister(BC_MEM_REG_CODE_POINTER) = readMemCellAndMove<Encoding>(BC_DT_ADDR, ocx.derefArg[0]);
 	}
-	inline void Interpreter::exec_insCall(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> MARC_INTERPRETER_INLINE void Interpreter::exec_insCall(BC_OpCodeEx ocx)
 	{
 		BC_MemAddress fpMem;
 		BC_MemAddress retMem;
@@ -258,8 +450,8 @@ namespace MarC
 		auto& regFP = getRegister(BC_MEM_REG_FRAME_POINTER);
 		auto& regCP = getRegister(BC_MEM_REG_CODE_POINTER);
 
-		BC_MemAddress funcAddr = readMemCellAndMove(BC_DT_ADDR, ocx.derefArg.get(0)).as_ADDR;
-		auto& fcd = readDataAndMove<BC_FuncCallData>();
+		BC_MemAddress funcAddr = readMemCellAndMove<Encoding>(BC_DT_ADDR, ocx.derefArg.get(0)).as_ADDR;
+		auto& fcd = readDataAndMove<Encoding, BC_FuncCallData>();
 		
 		virt_pushStack(BC_DatatypeSize(ocx.datatype)); // Reserve memory for return value
 		retMem = regSP.as_ADDR; // Copy address of memory for return address
@@ -271,7 +463,7 @@ namespace MarC
 		{
 			auto dt = fcd.argType.get(i);
 			virt_pushStack(
-				readMemCellAndMove(dt, ocx.derefArg.get(i + 1)),
+				readMemCellAndMove<Encoding>(dt, ocx.derefArg.get(i + 1)),
 				BC_DatatypeSize(dt)
 			);
 		}
@@ -279,13 +471,13 @@ namespace MarC
 		hostMemCell(fpMem).as_ADDR = regFP.as_ADDR; // Store the old frame pointer
 		fpMem.addr += 8; // Frame pointer points to first byte after frame pointer backup
 		regFP.as_ADDR = fpMem; // Initialize the new frame pointer
-		m_mem.baseTable[BC_MEM_BASE_DYNAMIC_FRAME] = (char*)m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] + regFP.as_ADDR.addr;
+		m_mem.baseTable[BC_MEM_BASE_DYNAMIC_FRAME] = (char*)m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] + fpMem.addr;
 
 		hostMemCell(retMem).as_ADDR = regCP.as_ADDR; // Store the return address
 
 		regCP.as_ADDR = funcAddr; // Jump to function address
 	}
-	inline void Interpreter::exec_insReturn(BC_OpCodeEx ocx)
+	MARC_INTERPRETER_INLINE void Interpreter::exec_insReturn(BC_OpCodeEx ocx)
 	{
 		UNUSED(ocx);
 		virt_popFrame();
@@ -295,55 +487,120 @@ namespace MarC
 		);
 	}
 
-	inline void Interpreter::virt_pushStack(uint64_t nBytes)
+	template <BC_CodeEncoding Encoding, class Observer> void Interpreter::exec_insAllocate(BC_OpCodeEx ocx, Observer& observer)
+	{
+		auto& addr = hostMemCell(readAddressAndMove<Encoding>(), ocx.derefArg[0]).as_ADDR;
+		addr = BC_MemAddress(BC_MEM_BASE_NONE, 0);
+		uint64_t size = readMemCellAndMove<Encoding>(BC_DT_U_64, ocx.derefArg[1]).as_U_64;
+		void* ptr = malloc(size);
+		if (!ptr)
+			return;
+		addr = BC_MemAddress(BC_MEM_BASE_EXTERN, m_mem.nextDynAddr);
+		m_mem.dynMemMap.insert({ addr, ptr });
+		m_mem.nextDynAddr += size;
+		observer.onAllocate(*this, addr, size);
+	}
+	template <BC_CodeEncoding Encoding, class Observer> void Interpreter::exec_insFree(BC_OpCodeEx ocx, Observer& observer)
+	{
+		auto& addr = readMemCellAndMove<Encoding>(BC_DT_ADDR, ocx.derefArg[0]).as_ADDR;
+		auto it = m_mem.dynMemMap.find(addr);
+		if (it != m_mem.dynMemMap.end())
+			free(it->second);
+		m_mem.dynMemMap.erase(addr);
+		observer.onFree(*this, addr);
+	}
+	template <BC_CodeEncoding Encoding, class Observer> void Interpreter::exec_insCallExtern(BC_OpCodeEx ocx, Observer& observer)
+	{
+		uint64_t argIndex = 0;
+
+		BC_MemAddress funcNameAddr = readMemCellAndMove<Encoding>(BC_DT_ADDR, ocx.derefArg[argIndex++]).as_ADDR;
+		auto& fcd = readDataAndMove<Encoding, BC_FuncCallData>();
+
+		ExternalFunctionPtr func = getExternalFunction(funcNameAddr);
+
+		ExFuncData efd;
+		efd.retVal.datatype = ocx.datatype;
+		efd.nParams = fcd.nArgs;
+
+		void* retDest = nullptr;
+		if (ocx.datatype != BC_DT_NONE)
+			retDest = hostAddress(readAddressAndMove<Encoding>(), ocx.derefArg[argIndex++]);
+
+		for (uint8_t i = 0; i < fcd.nArgs; ++i)
+		{
+			auto dt = fcd.argType.get(i);
+			efd.param[i].datatype = dt;
+			efd.param[i].cell = readMemCellAndMove<Encoding>(dt, ocx.derefArg.get(argIndex++));
+		}
+
+		observer.onCallExtern(*this, funcNameAddr);
+
+		func->call(*this, efd);
+
+		if (retDest)
+			memcpy(retDest, &efd.retVal.cell, BC_DatatypeSize(efd.retVal.datatype));
+	}
+
+	MARC_INTERPRETER_INLINE void Interpreter::virt_pushStack(uint64_t nBytes)
 	{
 		auto& regSP = getRegister(BC_MEM_REG_STACK_POINTER);
+		BC_MemAddress sp(regSP.as_ADDR._raw);
 
-		if (m_mem.dynamicStack.size() < regSP.as_ADDR.addr + nBytes)
+		if (m_mem.dynamicStack.size() < sp.addr + nBytes)
 		{
+			BC_MemAddress fp(getRegister(BC_MEM_REG_FRAME_POINTER).as_ADDR._raw);
 			m_mem.dynamicStack.resize(m_mem.dynamicStack.size() * 2);
 			m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] = m_mem.dynamicStack.getBaseAddress();
-			m_mem.baseTable[BC_MEM_BASE_DYNAMIC_FRAME] = (char*)m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] + getRegister(BC_MEM_REG_FRAME_POINTER).as_ADDR.addr;
+			m_mem.baseTable[BC_MEM_BASE_DYNAMIC_FRAME] = (char*)m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] + fp.addr;
 		}
 
-		regSP.as_ADDR.addr += nBytes;
+		sp.addr += nBytes;
+		regSP.as_ADDR = sp;
 	}
 
-	inline void Interpreter::virt_pushStack(const BC_MemCell& mc, uint64_t nBytes)
+	MARC_INTERPRETER_INLINE void Interpreter::virt_pushStack(const BC_MemCell& mc, uint64_t nBytes)
 	{
 		auto& regSP = getRegister(BC_MEM_REG_STACK_POINTER);
+		BC_MemAddress sp(regSP.as_ADDR._raw);
 
-		if (m_mem.dynamicStack.size() < regSP.as_ADDR.addr + nBytes)
+		if (m_mem.dynamicStack.size() < sp.addr + nBytes)
 		{
+			BC_MemAddress fp(getRegister(BC_MEM_REG_FRAME_POINTER).as_ADDR._raw);
 			m_mem.dynamicStack.resize(m_mem.dynamicStack.size() * 2);
 			m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] = m_mem.dynamicStack.getBaseAddress();
-			m_mem.baseTable[BC_MEM_BASE_DYNAMIC_FRAME] = (char*)m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] + getRegister(BC_MEM_REG_FRAME_POINTER).as_ADDR.addr;
+			m_mem.baseTable[BC_MEM_BASE_DYNAMIC_FRAME] = (char*)m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] + fp.addr;
 		}
 		
-		auto dest = hostAddress(regSP.as_ADDR);
+		auto dest = hostAddress(sp);
 
 		memcpy(dest, &mc, nBytes);
 
-		regSP.as_ADDR.addr += nBytes;
+		sp.addr += nBytes;
+		regSP.as_ADDR = sp;
 	}
 
-	inline void Interpreter::virt_popStack(uint64_t nBytes)
+	MARC_INTERPRETER_INLINE void Interpreter::virt_popStack(uint64_t nBytes)
 	{
-		getRegister(BC_MEM_REG_STACK_POINTER).as_ADDR.addr -= nBytes;
+		auto& regSP = getRegister(BC_MEM_REG_STACK_POINTER);
+		BC_MemAddress sp(regSP.as_ADDR._raw);
+		sp.addr -= nBytes;
+		regSP.as_ADDR = sp;
 	}
 
-	inline void Interpreter::virt_popStack(BC_MemCell& mc, uint64_t nBytes)
+	MARC_INTERPRETER_INLINE void Interpreter::virt_popStack(BC_MemCell& mc, uint64_t nBytes)
 	{
 		auto& regSP = getRegister(BC_MEM_REG_STACK_POINTER);
+		BC_MemAddress sp(regSP.as_ADDR._raw);
 
-		regSP.as_ADDR.addr -= nBytes;
+		sp.addr -= nBytes;
+		regSP.as_ADDR = sp;
 
-		auto src = hostAddress(regSP.as_ADDR);
+		auto src = hostAddress(sp);
 
 		memcpy((void*)&mc, src, nBytes);
 	}
 
-	inline void Interpreter::virt_pushFrame()
+	MARC_INTERPRETER_INLINE void Interpreter::virt_pushFrame()
 	{
 		auto& regSP = getRegister(BC_MEM_REG_STACK_POINTER);
 		auto& regFP = getRegister(BC_MEM_REG_FRAME_POINTER);
@@ -351,11 +608,12 @@ namespace MarC
 			regFP,
 			BC_DatatypeSize(BC_DT_ADDR)
 		);
-		regFP.as_ADDR = regSP.as_ADDR;
-		m_mem.baseTable[BC_MEM_BASE_DYNAMIC_FRAME] = (char*)m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] + regFP.as_ADDR.addr;
+		BC_MemAddress fp(regSP.as_ADDR._raw);
+		regFP.as_ADDR = fp;
+		m_mem.baseTable[BC_MEM_BASE_DYNAMIC_FRAME] = (char*)m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] + fp.addr;
 	}
 
-	inline void Interpreter::virt_popFrame()
+	MARC_INTERPRETER_INLINE void Interpreter::virt_popFrame()
 	{
 		auto& regSP = getRegister(BC_MEM_REG_STACK_POINTER);
 		auto& regFP = getRegister(BC_MEM_REG_FRAME_POINTER);
@@ -364,12 +622,14 @@ namespace MarC
 			regFP,
 			BC_DatatypeSize(BC_DT_ADDR)
 		);
-		m_mem.baseTable[BC_MEM_BASE_DYNAMIC_FRAME] = (char*)m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] + regFP.as_ADDR.addr;
+		BC_MemAddress fp(regFP.as_ADDR._raw);
+		m_mem.baseTable[BC_MEM_BASE_DYNAMIC_FRAME] = (char*)m_mem.baseTable[BC_MEM_BASE_DYNAMIC_STACK] + fp.addr;
 	}
 
-	inline bool Interpreter::reachedEndOfCode() const
+	MARC_INTERPRETER_INLINE bool Interpreter::reachedEndOfCode() const
 	{
-		return getRegister(BC_MEM_REG_CODE_POINTER).as_ADDR.addr >= (int64_t)m_mem.codeMemSize;
+		BC_MemAddress cp(getRegister(BC_MEM_REG_CODE_POINTER).as_ADDR._raw);
+		return cp.addr >= (int64_t)m_mem.codeMemSize;
 	}
 }
 
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#include "types/BytecodeTypes.h"
+#include "unused.h"
+
+namespace MarC
+{
+	class Interpreter;
+
+	// Base class for observers passed to Interpreter::interpret(nInstructions, observer).
+	// The dispatch loop is templated on the concrete observer type, so the hooks are
+	// resolved statically. Derived observers only hide the hooks they are interested in,
+	// the remaining empty hooks get inlined and compiled away.
+	struct InterpreterObserver
+	{
+		// Called after the opCode has been read, before the instruction gets executed.
+		void beforeInstruction(Interpreter& interpreter, const BC_OpCodeEx& ocx) { UNUSED(interpreter); UNUSED(ocx); }
+		// Called after the instruction has been executed successfully.
+		void afterInstruction(Interpreter& interpreter, const BC_OpCodeEx& ocx) { UNUSED(interpreter); UNUSED(ocx); }
+		// Called after a 'call' instruction has jumped to 'funcAddr'.
+		void onCall(Interpreter& interpreter, BC_MemAddress funcAddr) { UNUSED(interpreter); UNUSED(funcAddr); }
+		// Called after a 'return' instruction has jumped back to 'retAddr'.
+		void onReturn(Interpreter& interpreter, BC_MemAddress retAddr) { UNUSED(interpreter); UNUSED(retAddr); }
+		// Called before an external function gets invoked. 'funcNameAddr' points to the function name.
+		void onCallExtern(Interpreter& interpreter, BC_MemAddress funcNameAddr) { UNUSED(interpreter); UNUSED(funcNameAddr); }
+		// Called after 'size' bytes have been allocated at 'addr'.
+		void onAllocate(Interpreter& interpreter, BC_MemAddress addr, uint64_t size) { UNUSED(interpreter); UNUSED(addr); UNUSED(size); }
+		// Called after the memory at 'addr' has been freed.
+		void onFree(Interpreter& interpreter, BC_MemAddress addr) { UNUSED(interpreter); UNUSED(addr); }
+		// Called after the dynamic stack has been resized to 'newSize' bytes.
+		void onStackGrowth(Interpreter& interpreter, uint64_t newSize) { UNUSED(interpreter); UNUSED(newSize); }
+	};
+
+	typedef InterpreterObserver NullObserver;
+}
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_set>
 
 namespace MarC
 {
@@ -31,17 +35,44 @@ namespace MarC
 			Pragma_Insertion,
 			Comment,
 		} type = Type::None;
-		std::string value = "<undefined>";
+		std::string_view value = "<undefined>"; // Points into an AsmStringStore or a string literal
+		uint32_t pragmaIndex = 0; // Parsed index of Pragma_Insertion tokens
 	public:
 		AsmToken() = default;
-		AsmToken(uint16_t line, uint16_t column, Type type = Type::None, const std::string& value = "")
+		AsmToken(uint16_t line, uint16_t column, Type type = Type::None, std::string_view value = "")
 			: line(line), column(column), type(type), value(value)
 		{}
 	public:
 		bool operator<(const AsmToken& other) const { return value < other.value; }
 		bool operator>(const AsmToken& other) const { return value > other.value; }
 	};
-	typedef std::vector<AsmToken> AsmTokenList;
+
+	// Owns the characters the token values point into:
+	// The retained source code and the few values that don't exist verbatim in the source (e.g. unescaped strings).
+	class AsmStringStore
+	{
+	public:
+		// Takes ownership of a (large) buffer, e.g. source code.
+		const std::string& own(std::string buffer);
+		// Stores a short string, equal strings are only stored once.
+		std::string_view intern(std::string str);
+	private:
+		std::deque<std::string> m_buffers;
+		std::unordered_set<std::string> m_interned;
+	};
+	typedef std::shared_ptr<AsmStringStore> AsmStringStoreRef;
+
+	// Token list that keeps the string stores of its tokens alive.
+	class AsmTokenList : public std::vector<AsmToken>
+	{
+	public:
+		using std::vector<AsmToken>::vector;
+	public:
+		void retain(const AsmStringStoreRef& store);
+		void retain(const AsmTokenList& other);
+	private:
+		std::vector<AsmStringStoreRef> m_stores;
+	};
 	typedef std::shared_ptr<AsmTokenList> AsmTokenListRef;
 
 	std::string AsmTokenTypeToString(AsmToken::Type tt);
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <map>
+#include <deque>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include "Memory.h"
 #include "BytecodeTypes.h"
@@ -47,7 +50,7 @@ namespace MarC
 		{}
 	};
 
-	DirectiveID DirectiveIDFromString(const std::string& value);
+	DirectiveID DirectiveIDFromString(std::string_view value);
 
 	struct TypeCell
 	{
@@ -79,27 +82,43 @@ namespace MarC
 		bool operator<(const Symbol& other) const { return name < other.name; }
 	};
 
+	typedef uint32_t SymbolID;
+	constexpr SymbolID InvalidSymbolID = (SymbolID)-1;
+
+	// Interns full symbol names, every distinct name gets a dense integer ID.
+	class SymbolNameTable
+	{
+	public:
+		SymbolID intern(std::string_view name);
+		SymbolID find(std::string_view name) const;
+		const std::string& name(SymbolID id) const;
+		uint64_t size() const;
+	private:
+		std::deque<std::string> m_names; // Indexed by SymbolID, stable storage for the keys of m_ids
+		std::unordered_map<std::string_view, SymbolID> m_ids;
+	};
+
 	struct SymbolRef
 	{
 		SymbolRef() = default;
-		SymbolRef(const std::string& name, uint64_t offset, BC_Datatype datatype)
-			: name(name), offset(offset), datatype(datatype)
+		SymbolRef(SymbolID id, uint64_t offset, BC_Datatype datatype)
+			: id(id), offset(offset), datatype(datatype)
 		{}
 	public:
-		std::string name = "<unnamed>";
+		SymbolID id = InvalidSymbolID;
 		uint64_t offset = -1;
 		BC_Datatype datatype = BC_DT_NONE;
 	};
 
 	struct SymbolAlias
 	{
-		std::string name = "<unnamed>";
-		std::string refName = "<unknown>";
+		SymbolID id = InvalidSymbolID;
+		SymbolID refID = InvalidSymbolID;
 	public:
 		SymbolAlias() = default;
-		SymbolAlias(const std::string& name, const std::string& refName) : name(name), refName(refName) {}
+		SymbolAlias(SymbolID id, SymbolID refID) : id(id), refID(refID) {}
 	public:
-		bool operator<(const SymbolAlias& other) const { return name < other.name; }
+		bool operator<(const SymbolAlias& other) const { return id < other.id; }
 	};
 
 	template <>
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
 
 #include "fileio/Serializer.h"
 
@@ -74,6 +76,14 @@ namespace MarC
 		BC_OC_NUM_OF_OP_CODES,
 	};
 
+	// Layout of the instructions within the code memory.
+	enum class BC_CodeEncoding : uint8_t
+	{
+		Packed, // Operands directly follow each other.
+		Aligned, // Instructions start at 8 byte boundaries, operands are padded to their natural alignment.
+		Compact, // Like 'Packed', but address operands only take as many bytes as their offset needs (see 'BC_CompactAddrWidth').
+	};
+
 	enum BC_MemBase : uint8_t
 	{
 		BC_MEM_BASE_NONE = 0,
@@ -185,13 +195,13 @@ namespace MarC
 
 	#pragma pack(pop)
 
-	BC_OpCode BC_OpCodeFromString(const std::string& ocStr);
+	BC_OpCode BC_OpCodeFromString(std::string_view ocStr);
 	std::string BC_OpCodeToString(BC_OpCode oc);
 
-	BC_Datatype BC_DatatypeFromString(const std::string& dtStr);
+	BC_Datatype BC_DatatypeFromString(std::string_view dtStr);
 	std::string BC_DatatypeToString(BC_Datatype dt);
 
-	BC_MemRegister BC_RegisterFromString(const std::string& regStr);
+	BC_MemRegister BC_RegisterFromString(std::string_view regStr);
 	std::string BC_RegisterToString(BC_MemRegister reg);
 
 	std::string BC_MemCellToString(BC_MemCell mc, BC_Datatype dt);
@@ -209,4 +219,97 @@ namespace MarC
 		};
 		return sizeTable[dt];
 	}
+
+	constexpr uint64_t BC_InstructionAlignment(BC_CodeEncoding encoding)
+	{
+		return encoding == BC_CodeEncoding::Aligned ? 8 : 1;
+	}
+
+	// Alignment of an operand of 'size' bytes ('BC_FuncCallData' is aligned like its 4 byte member).
+	constexpr uint64_t BC_OperandAlignment(BC_CodeEncoding encoding, uint64_t size)
+	{
+		if (encoding != BC_CodeEncoding::Aligned)
+			return 1;
+		return size >= 8 ? 8 : size >= 4 ? 4 : size >= 2 ? 2 : 1;
+	}
+
+	constexpr uint64_t BC_AlignOffset(uint64_t offset, uint64_t alignment)
+	{
+		return (offset + alignment - 1) & ~(alignment - 1);
+	}
+
+	// Address operands of compact code start with a header byte holding the base (low nibble) and the width of the following offset (high nibble).
+	// Addresses that get relocated or resolved by the linker always use 'BC_CAW_32', so they can be patched in place.
+	enum BC_CompactAddrWidth : uint8_t
+	{
+		BC_CAW_0 = 0, // Offset 0, no further bytes
+		BC_CAW_8,
+		BC_CAW_16,
+		BC_CAW_32,
+		BC_CAW_64,
+	};
+	static_assert(_BC_MEM_BASE_NUM <= 16, "The base of compact addresses has to fit into 4 bits!");
+
+	inline uint64_t BC_CompactAddressSize(uint8_t header)
+	{
+		// Invalid widths take no further bytes, BC_ReadCompactAddress() reads them as offset 0 and the verifier rejects them.
+		static constexpr uint64_t sizeTable[16] = { 1, 2, 3, 5, 9, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 };
+		return sizeTable[header >> 4];
+	}
+
+	inline bool BC_CompactAddressFits(BC_MemAddress addr, BC_CompactAddrWidth width)
+	{
+		switch (width)
+		{
+		case BC_CAW_0: return addr.addr == 0;
+		case BC_CAW_8: return addr.addr == (int8_t)addr.addr;
+		case BC_CAW_16: return addr.addr == (int16_t)addr.addr;
+		case BC_CAW_32: return addr.addr == (int32_t)addr.addr;
+		default: return true;
+		}
+	}
+
+	inline BC_CompactAddrWidth BC_CompactAddressWidth(BC_MemAddress addr)
+	{
+		uint8_t width = BC_CAW_0;
+		while (!BC_CompactAddressFits(addr, (BC_CompactAddrWidth)width))
+			++width;
+		return (BC_CompactAddrWidth)width;
+	}
+
+	// Writes the header and the offset to 'dest' and returns the number of bytes written. 'addr' has to fit into 'width'.
+	inline uint64_t BC_WriteCompactAddress(void* dest, BC_MemAddress addr, BC_CompactAddrWidth width)
+	{
+		uint8_t* pDest = (uint8_t*)dest;
+		pDest[0] = (uint8_t)(addr.base | (width << 4));
+		int64_t offset = addr.addr;
+		uint64_t size = BC_CompactAddressSize(pDest[0]) - 1;
+		// Little endian, the low bytes of the offset come first.
+		memcpy(pDest + 1, &offset, size);
+		return size + 1;
+	}
+
+	inline BC_MemAddress BC_ReadCompactAddress(const void* src)
+	{
+		const uint8_t* pSrc = (const uint8_t*)src;
+		auto base = (BC_MemBase)(pSrc[0] & 15);
+		switch (pSrc[0] >> 4)
+		{
+		case BC_CAW_8: { int8_t offset; memcpy(&offset, pSrc + 1, sizeof(offset)); return BC_MemAddress(base, offset); }
+		case BC_CAW_16: { int16_t offset; memcpy(&offset, pSrc + 1, sizeof(offset)); return BC_MemAddress(base, offset); }
+		case BC_CAW_32: { int32_t offset; memcpy(&offset, pSrc + 1, sizeof(offset)); return BC_MemAddress(base, offset); }
+		case BC_CAW_64: { int64_t offset; memcpy(&offset, pSrc + 1, sizeof(offset)); return BC_MemAddress(base, offset); }
+		default: return BC_MemAddress(base, 0);
+		}
+	}
+
+	// Overwrites a compact address operand keeping its width. Returns false if 'addr' doesn't fit.
+	inline bool BC_PatchCompactAddress(void* dest, BC_MemAddress addr)
+	{
+		auto width = (BC_CompactAddrWidth)(*(const uint8_t*)dest >> 4);
+		if (!BC_CompactAddressFits(addr, width))
+			return false;
+		BC_WriteCompactAddress(dest, addr, width);
+		return true;
+	}
 }
@@ -12,6 +12,7 @@ namespace MarC
 		DerefCount derefCount = 0;
 		TypeCell value;
 		InsArgType argType;
+		uint64_t offset = 0; // Position of the argument's value within the instruction.
 	};
 
 	struct DisAsmInsInfo
@@ -21,6 +22,15 @@ namespace MarC
 		std::vector<char> rawData;
 	};
 
+	// Result of Disassembler::disassembleChecked().
+	enum class DisAsmCheck
+	{
+		Ok,
+		InvalidOpCode,
+		InvalidDatatype,
+		Truncated, // The instruction exceeds the end of the code.
+	};
+
 	std::set<Symbol>::const_iterator getSymbolForAddress(BC_MemAddress addr, const std::set<Symbol>& symbols, const std::string& scopeName = "");
 
 	std::string DisAsmInsInfoToString(const DisAsmInsInfo& daii, const std::set<Symbol>& symbols);
@@ -13,6 +13,10 @@ namespace MarC
 		Memory dynamicStack;
 		void* baseTable[_BC_MEM_BASE_NUM] = { nullptr };
 		uint64_t codeMemSize = 0;
+		// Decoded compact address operands. Each one is used before the fourth next one gets decoded: conditional jumps
+		// hold three of them at once, 'call'/'calx' copy every argument before reading the next one.
+		BC_MemCell compactOperands[4];
+		uint8_t nextCompactOperand = 0;
 		int64_t nextDynAddr = 0;
 		std::map<BC_MemAddress, void*> dynMemMap;
 	};
@@ -4,9 +4,16 @@
 
 namespace MarC
 {
+	struct MacroParamSlot
+	{
+		uint64_t tokenIndex; // Position in Macro::tokenList
+		uint64_t paramIndex; // Index into Macro::parameters
+	};
+
 	struct Macro
 	{
 		std::vector<AsmToken> parameters;
 		AsmTokenList tokenList;
+		std::vector<MacroParamSlot> paramSlots; // Sorted by tokenIndex, computed once when the macro gets defined
 	};
 }
\ No newline at end of file
@@ -1,11 +1,21 @@
 #include "AsmTokenizer.h"
 
+#include "AsmScanning.h"
+
 namespace MarC
 {
 	AsmTokenizer::AsmTokenizer(const std::string& asmCode)
-		: m_asmCode(asmCode)
+		: m_pStore(std::make_shared<AsmStringStore>()), m_asmCode(asmCode), m_ownsCode(false)
+	{
+		m_pTokenList = std::make_shared<AsmTokenList>();
+		m_pTokenList->retain(m_pStore);
+	}
+
+	AsmTokenizer::AsmTokenizer(std::string&& asmCode)
+		: m_pStore(std::make_shared<AsmStringStore>()), m_asmCode(m_pStore->own(std::move(asmCode))), m_ownsCode(true)
 	{
 		m_pTokenList = std::make_shared<AsmTokenList>();
+		m_pTokenList->retain(m_pStore);
 	}
 
 	bool AsmTokenizer::tokenize()
@@ -33,41 +43,46 @@ namespace MarC
 
 		AsmToken currToken(line, 1);
 
+		// Token values are views into 'code', only values that don't exist verbatim get built in 'unescaped'.
+		uint64_t tokenBegin = 0;
+		bool hasEscapeCode = false;
+		std::string unescaped;
+
 		auto tokenizeEscapeCode = [&](char c) {
 			switch (c)
 			{
 			case 'a':
-				currToken.value.push_back('\a');
+				unescaped.push_back('\a');
 				break;
 			case 'b':
-				currToken.value.push_back('\b');
+				unescaped.push_back('\b');
 				break;
 			case 't':
-				currToken.value.push_back('\t');
+				unescaped.push_back('\t');
 				break;
 			case 'n':
-				currToken.value.push_back('\n');
+				unescaped.push_back('\n');
 				break;
 			case 'v':
-				currToken.value.push_back('\v');
+				unescaped.push_back('\v');
 				break;
 			case 'f':
-				currToken.value.push_back('\f');
+				unescaped.push_back('\f');
 				break;
 			case 'r':
-				currToken.value.push_back('\r');
+				unescaped.push_back('\r');
 				break;
 			case 'e':
-				currToken.value.push_back('\033');
+				unescaped.push_back('\033');
 				break;
 			case '\'':
-				currToken.value.push_back(c);
+				unescaped.push_back(c);
 				break;
 			case '\"':
-				currToken.value.push_back(c);
+				unescaped.push_back(c);
 				break;
 			case '\\':
-				currToken.value.push_back(c);
+				unescaped.push_back(c);
 				break;
 			default:
 				ASM_TOKENIZER_THROW_ERROR(AsmTokErrCode::UnexpectedChar, std::string("Unexpected char '") + c + "' for escape sequence!");
@@ -79,11 +94,25 @@ namespace MarC
 
 		backup();
 
+		// Code that isn't owned by the tokenizer may change after this call, the tokens need a stable copy.
+		const std::string* pCode = &m_asmCode;
+		uint64_t firstChar = m_nextCharToTokenize;
+		if (!m_ownsCode)
+		{
+			pCode = &m_pStore->own(m_asmCode.substr(m_nextCharToTokenize));
+			firstChar = 0;
+		}
+		const std::string& code = *pCode;
+
+		auto tokenView = [&](uint64_t end) {
+			return std::string_view(code.data() + tokenBegin, end - tokenBegin);
+		};
+
 		try
 		{
-			for (uint64_t nextChar = m_nextCharToTokenize; nextChar <= m_asmCode.size(); ++nextChar)
+			for (uint64_t nextChar = firstChar; nextChar <= code.size(); ++nextChar)
 			{
-				char c = m_asmCode[nextChar];
+				char c = code[nextChar];
 
 				switch (currAction)
 				{
@@ -92,6 +121,9 @@ namespace MarC
 					{
 					case ' ':
 					case '\t':
+						nextChar = AsmScan::skipBlanks(code, nextChar + 1) - 1;
+						currAction = CurrAction::EndToken;
+						break;
 					case '\0':
 						currAction = CurrAction::EndToken;
 						break;
@@ -150,30 +182,35 @@ namespace MarC
 					case '"':
 						currToken.type = AsmToken::Type::String;
 						currAction = CurrAction::TokenizeString;
+						tokenBegin = nextChar + 1;
+						hasEscapeCode = false;
 						break;
 					case '%':
 						currToken.type = AsmToken::Type::Pragma_Insertion;
 						currAction = CurrAction::TokenizePragmaInsertion;
+						tokenBegin = nextChar + 1;
 						break;
 					case '\'':
 						currToken.type = AsmToken::Type::Integer;
 						currAction = CurrAction::TokenizeChar;
+						unescaped.clear();
 						break;
 					case '/':
 						currToken.type = AsmToken::Type::Comment;
 						currAction = CurrAction::TokenizeComment;
+						nextChar = AsmScan::findLineEnd(code, nextChar + 1) - 1;
 						break;
 					default:
 						if (std::isdigit(c) || c == '+' || c == '-')
 						{
 							currToken.type = AsmToken::Type::Integer;
-							currToken.value.push_back(c);
+							tokenBegin = nextChar;
 							currAction = CurrAction::TokenizeInteger;
 						}
 						else if (std::isalpha(c) || c == '>' || c == '_')
 						{
 							currToken.type = AsmToken::Type::Name;
-							currToken.value.push_back(c);
+							tokenBegin = nextChar;
 							currAction = CurrAction::TokenizeName;
 						}
 						else
@@ -186,26 +223,36 @@ namespace MarC
 					switch (c)
 					{
 					case '"':
+						currToken.value = hasEscapeCode ? m_pStore->intern(unescaped) : tokenView(nextChar);
 						currAction = CurrAction::EndToken;
 						break;
 					case '\\':
+						if (!hasEscapeCode)
+						{
+							unescaped.assign(tokenView(nextChar));
+							hasEscapeCode = true;
+						}
 						currAction = CurrAction::TokenizeStringEscapeCode;
 						break;
 					default:
-						currToken.value.push_back(c);
+						if (hasEscapeCode)
+							unescaped.push_back(c);
 					}
 					break;
 				case CurrAction::TokenizePragmaInsertion:
 					if (!std::isdigit(c))
 					{
-						if (currToken.value.empty())
+						if (nextChar == tokenBegin)
 							ASM_TOKENIZER_THROW_ERROR(AsmTokErrCode::UnexpectedChar, "Expected integer after pragma insertion sign!");
+						currToken.value = tokenView(nextChar);
 						currAction = CurrAction::EndToken;
 						--nextChar;
 					}
 					else
 					{
-						currToken.value.push_back(c);
+						if (currToken.pragmaIndex > (UINT32_MAX - 9) / 10)
+							ASM_TOKENIZER_THROW_ERROR(AsmTokErrCode::PlainContext, "Pragma insertion index is too large!");
+						currToken.pragmaIndex = currToken.pragmaIndex * 10 + uint32_t(c - '0');
 					}
 					break;
 				case CurrAction::TokenizeStringEscapeCode:
@@ -221,7 +268,7 @@ namespace MarC
 						currAction = CurrAction::TokenizeCharEscapeCode;
 						break;
 					default:
-						currToken.value.push_back(c);
+						unescaped.push_back(c);
 						currAction = CurrAction::TokenizeCharDelim;
 					}
 					break;
@@ -232,7 +279,7 @@ namespace MarC
 				case CurrAction::TokenizeCharDelim:
 					if (c != '\'')
 						ASM_TOKENIZER_THROW_ERROR(AsmTokErrCode::UnexpectedChar, "Expected delimiter for char literal!");
-					currToken.value = std::to_string((int)currToken.value[0]);
+					currToken.value = m_pStore->intern(std::to_string((int)unescaped[0]));
 					currAction = CurrAction::EndToken;
 					break;
 				case CurrAction::TokenizeComment:
@@ -243,22 +290,22 @@ namespace MarC
 					}
 					else
 					{
-						currToken.value.push_back(c);
+						nextChar = AsmScan::findLineEnd(code, nextChar + 1) - 1;
 					}
 					break;
 				case CurrAction::TokenizeInteger:
 					if (std::isdigit(c))
 					{
-						currToken.value.push_back(c);
+						nextChar = AsmScan::skipDigits(code, nextChar + 1) - 1;
 					}
 					else if (c == '.')
 					{
 						currToken.type = AsmToken::Type::Float;
-						currToken.value.push_back(c);
 						currAction = CurrAction::TokenizeFloat;
 					}
 					else if (c == ':' || c == ' ' || c == '\t' || c == '\n' || c == '\0')
 					{
+						currToken.value = tokenView(nextChar);
 						currAction = CurrAction::EndToken;
 						--nextChar;
 					}
@@ -270,10 +317,11 @@ namespace MarC
 				case CurrAction::TokenizeFloat:
 					if (std::isdigit(c))
 					{
-						currToken.value.push_back(c);
+						nextChar = AsmScan::skipDigits(code, nextChar + 1) - 1;
 					}
 					else if (c == ':' || c == ' ' || c == '\t' || c == '\n' || c == '\0')
 					{
+						currToken.value = tokenView(nextChar);
 						currAction = CurrAction::EndToken;
 						--nextChar;
 					}
@@ -285,10 +333,11 @@ namespace MarC
 				case CurrAction::TokenizeName:
 					if (std::isalnum(c) || c == '_' || c == '>')
 					{
-						currToken.value.push_back(c);
+						nextChar = AsmScan::skipNameChars(code, nextChar + 1) - 1;
 					}
 					else if (c == ':' || c == ' ' || c == '\t' || c == '\n' || c == '\0' || c == '.')
 					{
+						currToken.value = tokenView(nextChar);
 						currAction = CurrAction::EndToken;
 						--nextChar;
 					}
@@ -310,7 +359,7 @@ namespace MarC
 					{
 						m_pTokenList->push_back(currToken);
 					}
-					currToken = AsmToken(line, uint16_t(nextChar - lineBegin));
+					currToken = AsmToken(line, uint16_t(nextChar - lineBegin), AsmToken::Type::None, "");
 					currAction = CurrAction::BeginToken;
 				}
 			}
@@ -1,5 +1,7 @@
 #include "Assembler.h"
 
+#include <algorithm>
+
 #include "AsmTokenizer.h"
 #include "VirtualAsmTokenList.h"
 #include "SearchAlgorithms.h"
@@ -10,7 +12,7 @@
 namespace MarC
 {
 	Assembler::Assembler(const ModulePackRef modPack)
-		: m_pModPack(modPack), m_pCurrTokenList(modPack->tokenList)
+		: m_pModPack(modPack), m_pCurrTokenList(modPack->tokenList), m_pStringStore(std::make_shared<AsmStringStore>())
 	{
 		m_pModInfo = ModuleInfo::create();
 		m_pModInfo->exeInfo->name = modPack->name;
@@ -78,7 +80,7 @@ namespace MarC
 		else if (isDirective())
 			assembleDirective();
 		else
-			MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unknown statement '" + currToken().value + "'!");
+			MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unknown statement '" + std::string(currToken().value) + "'!");
 
 		uint64_t nNewlines = 0;
 		while (nextToken().type == AsmToken::Type::Sep_Newline)
@@ -114,7 +116,7 @@ namespace MarC
 			{
 				ocx.datatype = BC_DatatypeFromString(nextToken().value);
 				if (ocx.datatype == BC_DT_UNKNOWN)
-					MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert token '" + currToken().value + "' to datatype!");
+					MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert token '" + std::string(currToken().value) + "' to datatype!");
 			}
 			else
 			{
@@ -124,6 +126,7 @@ namespace MarC
 			}
 		}
 
+		alignCode(BC_InstructionAlignment(codeEncoding()));
 		DelayedPush<BC_OpCodeEx> ocxDelayed(*this, ocx);
 
 		if (layout.flags.hasFlag(InsFlag::CustomImplementation))
@@ -256,11 +259,34 @@ namespace MarC
 		case InsArgType::Datatype: tc.datatype = BC_DT_DATATYPE; break;
 		}
 
+		// Symbol references and relocations record the offset of the padded operand.
+		bool isDeref = currToken().type == AsmToken::Type::Op_Deref;
+		alignCode(BC_OperandAlignment(codeEncoding(), BC_DatatypeSize(isDeref ? BC_DT_ADDR : tc.datatype)));
+
+		uint64_t nSymbolRefs = m_pModInfo->unresolvedSymbolRefs.size();
 		DerefCount dc;
 		generateTypeCell(tc, dc);
 
 		ocx.derefArg.set(arg.index, dc);
 
+		bool isRelocated = tc.datatype == BC_DT_ADDR && (tc.cell.as_ADDR.base == BC_MEM_BASE_CODE_MEMORY || tc.cell.as_ADDR.base == BC_MEM_BASE_STATIC_STACK);
+		if (isRelocated)
+			m_pModInfo->codeRelocations.push_back(currCodeOffset());
+
+		if (tc.datatype == BC_DT_ADDR && codeEncoding() == BC_CodeEncoding::Compact)
+		{
+			// The linker patches these in place, the width has to fit any (object relative) code/static address.
+			auto width = BC_CompactAddressWidth(tc.cell.as_ADDR);
+			if (isRelocated || m_pModInfo->unresolvedSymbolRefs.size() != nSymbolRefs)
+				width = BC_CAW_32;
+			if (!BC_CompactAddressFits(tc.cell.as_ADDR, width))
+				MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "The address '" + BC_MemAddressToString(tc.cell.as_ADDR) + "' is too large for the compact encoding!");
+
+			char buffer[sizeof(BC_MemAddress) + 1];
+			pushCode(buffer, BC_WriteCompactAddress(buffer, tc.cell.as_ADDR, width));
+			return;
+		}
+
 		pushCode(&tc.cell, BC_DatatypeSize(tc.datatype));
 	}
 
@@ -301,7 +327,7 @@ namespace MarC
 	{
 		auto reg = BC_RegisterFromString(nextToken().value);
 		if (reg == BC_MEM_REG_NONE || reg == BC_MEM_REG_UNKNOWN)
-			MARC_ASSEMBLER_THROW(AsmErrCode::UnknownRegisterName, currToken().value);
+			MARC_ASSEMBLER_THROW(AsmErrCode::UnknownRegisterName, std::string(currToken().value));
 		tc.cell.as_ADDR = BC_MemAddress(BC_MEM_BASE_REGISTER, reg);
 	}
 
@@ -320,7 +346,7 @@ namespace MarC
 
 		if (currToken().type == AsmToken::Type::Integer)
 		{
-			int64_t offset = std::stoll(currToken().value);
+			int64_t offset = std::stoll(std::string(currToken().value));
 
 			tc.cell.as_ADDR = BC_MemAddress(BC_MEM_BASE_DYNAMIC_FRAME, offset);
 
@@ -337,7 +363,7 @@ namespace MarC
 
 		tc.cell.as_U_64 = BC_DatatypeSize(BC_DatatypeFromString(currToken().value));
 		if (tc.cell.as_U_64 == 0)
-			MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert name '" + currToken().value + "' to datatype!");
+			MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert name '" + std::string(currToken().value) + "' to datatype!");
 	}
 
 	void Assembler::generateTypeCellName(TypeCell& tc)
@@ -346,13 +372,13 @@ namespace MarC
 		{
 			tc.cell.as_Datatype = BC_DatatypeFromString(currToken().value);
 			if (tc.cell.as_Datatype == BC_DT_UNKNOWN)
-				MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert token '" + currToken().value + "' to datatype!");
+				MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert token '" + std::string(currToken().value) + "' to datatype!");
 			return;
 		}
 
 		m_pModInfo->unresolvedSymbolRefs.push_back(
 			{
-				getScopedName(currToken().value),
+				getScopedID(currToken().value),
 				currCodeOffset(),
 				tc.datatype
 			}
@@ -365,7 +391,8 @@ namespace MarC
 			MARC_ASSEMBLER_THROW(AsmErrCode::DatatypeMismatch, BC_DatatypeToString(tc.datatype));
 
 		tc.cell.as_ADDR = currStaticStackAddr();
-		m_pModInfo->exeInfo->staticStack.push(currToken().value.c_str(), currToken().value.size() + 1);
+		m_pModInfo->exeInfo->staticStack.push(currToken().value.data(), currToken().value.size());
+		m_pModInfo->exeInfo->staticStack.push('\0');
 	}
 
 	void Assembler::generateTypeCellFloat(TypeCell& tc, DerefCount dc)
@@ -375,9 +402,9 @@ namespace MarC
 		switch (tc.datatype)
 		{
 		case BC_DT_F_32:
-			tc.cell.as_F_32 = std::stof(currToken().value); break;
+			tc.cell.as_F_32 = std::stof(std::string(currToken().value)); break;
 		case BC_DT_F_64:
-			tc.cell.as_F_64 = std::stod(currToken().value); break;
+			tc.cell.as_F_64 = std::stod(std::string(currToken().value)); break;
 		default:
 			MARC_ASSEMBLER_THROW(AsmErrCode::DatatypeMismatch, BC_DatatypeToString(tc.datatype));
 		}
@@ -388,8 +415,8 @@ namespace MarC
 		if (!dc && (tc.datatype == BC_DT_F_32 || tc.datatype == BC_DT_F_64))
 			MARC_ASSEMBLER_THROW(AsmErrCode::DatatypeMismatch, BC_DatatypeToString(tc.datatype));
 
-		tc.cell.as_U_64 = std::stoull(positiveString(currToken().value));
-		if (isNegativeString(currToken().value))
+		tc.cell.as_U_64 = std::stoull(positiveString(std::string(currToken().value)));
+		if (isNegativeString(std::string(currToken().value)))
 		{
 			if (dc)
 				MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Cannot dereference literal with negative value!");
@@ -424,14 +451,14 @@ namespace MarC
 		UNUSED(arg);
 		auto dt = BC_DatatypeFromString(nextToken().value);
 		if (dt == BC_DT_UNKNOWN)
-			MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert token '" + currToken().value + "' to datatype!");
+			MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert token '" + std::string(currToken().value) + "' to datatype!");
 
 		pushCode(dt);
 	}
 
 	void Assembler::assembleMacroExpansion()
 	{
-		std::string macroName = currToken().value;
+		std::string macroName(currToken().value);
 
 		bool hasDatatype = true;
 		if (nextToken().type != AsmToken::Type::Sep_Dot)
@@ -486,7 +513,7 @@ namespace MarC
 		{
 		case DirectiveID::None:
 		case DirectiveID::Unknown:
-			MARC_ASSEMBLER_THROW(AsmErrCode::UnknownDirective, currToken().value);
+			MARC_ASSEMBLER_THROW(AsmErrCode::UnknownDirective, std::string(currToken().value));
 			break;
 		case DirectiveID::Label:
 			return assembleDirLabel();
@@ -522,7 +549,7 @@ namespace MarC
 			return assembleDirPragmaReplace();
 		}
 
-		MARC_ASSEMBLER_THROW(AsmErrCode::UnknownDirective, currToken().value);
+		MARC_ASSEMBLER_THROW(AsmErrCode::UnknownDirective, std::string(currToken().value));
 	}
 
 	void Assembler::assembleDirLabel()
@@ -532,7 +559,7 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::Name)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Name, currToken());
 
-		addSymbol({ currToken().value, SymbolUsage::Address, currCodeAddr() });
+		addSymbol({ std::string(currToken().value), SymbolUsage::Address, currCodeAddr() });
 	}
 
 	void Assembler::assembleDirAlias()
@@ -571,10 +598,10 @@ namespace MarC
 			symbol.usage = SymbolUsage::Value;
 			break;
 		case AsmToken::Type::Name:
-			addSymbolAlias({ symbol.name, currToken().value });
+			addSymbolAlias(symbol.name, currToken().value);
 			return;
 		default:
-			MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unexpected token'" + currToken().value + "' for alias value!");
+			MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unexpected token'" + std::string(currToken().value) + "' for alias value!");
 		}
 
 		DerefCount dc;
@@ -595,7 +622,7 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::Name)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Name, currToken());
 
-		std::string name = currToken().value;
+		std::string name(currToken().value);
 
 		removeNecessaryColon();
 
@@ -624,7 +651,19 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::String)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::String, currToken());
 
-		std::string modName = currToken().value;
+		std::string modName(currToken().value);
+
+		if (m_resolveObject)
+		{
+			auto& reqMods = m_pModInfo->requiredModules;
+			if (std::find(reqMods.begin(), reqMods.end(), modName) == reqMods.end())
+			{
+				reqMods.push_back(modName);
+				m_pModInfo->requiredModuleOffsets.push_back(currCodeAddr().addr);
+			}
+			importObjectMacros(modName);
+			return;
+		}
 
 		if (m_resolvedDependencies.find(modName) != m_resolvedDependencies.end())
 			return;
@@ -638,6 +677,47 @@ namespace MarC
 		m_resolvedDependencies.insert(modIt->first);
 	}
 
+	void Assembler::importObjectMacros(const std::string& modName)
+	{
+		if (m_resolvedDependencies.find(modName) != m_resolvedDependencies.end())
+			return;
+		m_resolvedDependencies.insert(modName);
+
+		ModuleInfoRef object = m_resolveObject(modName);
+		if (!object)
+			MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to resolve dependency '" + modName + "'!");
+
+		// Macros of indirect dependencies were visible as well when modules got assembled in one piece.
+		for (auto& reqMod : object->requiredModules)
+			importObjectMacros(reqMod);
+
+		for (auto& [name, macro] : object->macros)
+		{
+			if (object->importedMacros.find(name) != object->importedMacros.end())
+				continue;
+			if (macroExists(name))
+				MARC_ASSEMBLER_THROW(AsmErrCode::MacroAlreadyDefined, name);
+			m_pModInfo->macros.insert({ name, macro });
+			m_pModInfo->importedMacros.insert(name);
+		}
+	}
+
+	void Assembler::setCodeEncoding(BC_CodeEncoding encoding)
+	{
+		m_pModInfo->exeInfo->codeEncoding = encoding;
+	}
+
+	void Assembler::setObjectResolver(ObjectResolver resolver)
+	{
+		m_resolveObject = resolver;
+
+		// Generated names must not collide with the ones of other objects.
+		m_pragmaSuffix = "__";
+		for (char c : m_pModPack->name)
+			m_pragmaSuffix.push_back(std::isalnum(c) ? c : '_');
+		m_pragmaSuffix.append("__");
+	}
+
 	void Assembler::assembleDirExtension()
 	{
 		removeNecessaryColon();
@@ -645,7 +725,7 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::String)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::String, currToken());
 
-		std::string extName = currToken().value;
+		std::string extName(currToken().value);
 
 		m_pModInfo->exeInfo->requiredExtensions.insert(extName);
 	}
@@ -657,7 +737,7 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::Name)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Name, currToken());
 
-		addScope(currToken().value);
+		addScope(std::string(currToken().value));
 	}
 
 	void Assembler::assembleDirEnd()
@@ -685,7 +765,7 @@ namespace MarC
 
 			dt = BC_DatatypeFromString(currToken().value);
 			if (dt == BC_DT_UNKNOWN)
-				MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert token '" + currToken().value + "' to datatype!");
+				MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert token '" + std::string(currToken().value) + "' to datatype!");
 		}
 
 		removeNecessaryColon();
@@ -724,7 +804,7 @@ namespace MarC
 			if (nextToken().type != AsmToken::Type::Name)
 				MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Name, currToken());
 
-			std::string retName = currToken().value;
+			std::string retName(currToken().value);
 
 			assembleStatement("#alias : " + retName + " : ~-" + std::to_string(2 * BC_DatatypeSize(BC_DT_U_64) + BC_DatatypeSize(dt)));
 		}
@@ -737,7 +817,7 @@ namespace MarC
 
 			BC_Datatype dt = BC_DatatypeFromString(currToken().value);
 			if (dt == BC_DT_UNKNOWN)
-				MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert token '" + currToken().value + "' to datatype!");
+				MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Unable to convert token '" + std::string(currToken().value) + "' to datatype!");
 
 			if (nextToken().type != AsmToken::Type::Sep_Dot)
 				MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Sep_Dot, currToken());
@@ -745,7 +825,7 @@ namespace MarC
 			if (nextToken().type != AsmToken::Type::Name)
 				MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Name, currToken());
 
-			std::string valName = currToken().value;
+			std::string valName(currToken().value);
 
 			assembleStatement("#alias : " + valName + " : ~+" + std::to_string(paramOffset));
 
@@ -764,7 +844,7 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::Name)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Name, currToken());
 
-		std::string name = currToken().value;
+		std::string name(currToken().value);
 
 		assembleStatement("#alias : " + name + " : \"" + getScopedName(name) + "\"");
 	}
@@ -781,7 +861,7 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::Name)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Name, currToken());
 
-		std::string name = currToken().value;
+		std::string name(currToken().value);
 
 		TypeCell tc;
 		tc.datatype = BC_DT_U_64;
@@ -811,7 +891,7 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::Name)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Name, currToken());
 
-		std::string name = currToken().value;
+		std::string name(currToken().value);
 
 		m_pModInfo->exeInfo->mandatoryPermissions.insert(name);
 	}
@@ -823,7 +903,7 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::Name)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Name, currToken());
 
-		std::string name = currToken().value;
+		std::string name(currToken().value);
 
 		m_pModInfo->exeInfo->optionalPermissions.insert(name);
 	}
@@ -878,11 +958,26 @@ namespace MarC
 			macro.tokenList.push_back(currTokenNoModify());
 		}
 		macro.tokenList.push_back(AsmToken(0, 0, AsmToken::Type::END_OF_CODE));
+		macro.tokenList.retain(*m_pCurrTokenList);
+		macro.tokenList.retain(m_pStringStore);
+
+		for (uint64_t i = 0; i < macro.tokenList.size(); ++i)
+		{
+			if (macro.tokenList[i].type != AsmToken::Type::Name)
+				continue;
+			for (uint64_t j = 0; j < macro.parameters.size(); ++j)
+			{
+				if (macro.parameters[j].value != macro.tokenList[i].value)
+					continue;
+				macro.paramSlots.push_back({ i, j });
+				break;
+			}
+		}
 
 		if (nextToken().value != "end")
 			MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Plain directives are not allowed in macro definitions!");
 
-		addMacro(macroName, macro);
+		addMacro(macroName, std::move(macro));
 	}
 
 	void Assembler::assembleDirPragmaPush()
@@ -892,10 +987,10 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::Name)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Name, currToken());
 
-		std::string name = currToken().value;
-		name.append("__" + std::to_string(++m_nextPragmaIndex));
+		std::string name(currToken().value);
+		name.append(m_pragmaSuffix + std::to_string(++m_nextPragmaIndex));
 
-		m_pragmaList.push_back(AsmToken(currTokenNoModify().line, currTokenNoModify().column, AsmToken::Type::Name, name));
+		m_pragmaList.push_back(AsmToken(currTokenNoModify().line, currTokenNoModify().column, AsmToken::Type::Name, m_pStringStore->intern(name)));
 	}
 
 	void Assembler::assembleDirPragmaPop()
@@ -912,7 +1007,7 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::Integer)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Integer, currToken());
 
-		int64_t pragmaIndex = std::stoll(currToken().value);
+		int64_t pragmaIndex = std::stoll(std::string(currToken().value));
 		if (pragmaIndex < 0)
 			MARC_ASSEMBLER_THROW_NO_CONTEXT(AsmErrCode::InvalidPragmaIndex);
 
@@ -921,10 +1016,10 @@ namespace MarC
 		if (nextToken().type != AsmToken::Type::Name)
 			MARC_ASSEMBLER_THROW_UNEXPECTED_TOKEN(AsmToken::Type::Name, currToken());
 
-		std::string name = currToken().value;
-		name.append("__" + std::to_string(++m_nextPragmaIndex));
+		std::string name(currToken().value);
+		name.append(m_pragmaSuffix + std::to_string(++m_nextPragmaIndex));
 
-		*(m_pragmaList.end() - 1 - pragmaIndex) = AsmToken(currTokenNoModify().line, currTokenNoModify().column, AsmToken::Type::Name, name);
+		*(m_pragmaList.end() - 1 - pragmaIndex) = AsmToken(currTokenNoModify().line, currTokenNoModify().column, AsmToken::Type::Name, m_pStringStore->intern(name));
 	}
 
 	void Assembler::assembleSubTokenList(AsmTokenListRef tokenList)
@@ -967,7 +1062,7 @@ namespace MarC
 				val.append(tok.value);
 				break;
 			case AsmToken::Type::String:
-				val.append("\"" + tok.value + "\"");
+				val.append("\"" + std::string(tok.value) + "\"");
 				break;
 			default:
 				prevToken();
@@ -983,7 +1078,7 @@ namespace MarC
 	void Assembler::addSymbol(Symbol symbol)
 	{
 		symbol.name = getScopedName(symbol.name);
-		m_pModInfo->exeInfo->symbols.insert(symbol);
+		m_pModInfo->defineSymbol(m_pModInfo->symbolNames.intern(symbol.name), symbol);
 	}
 
 	void Assembler::addScope(const std::string& name)
@@ -991,6 +1086,7 @@ namespace MarC
 		addSymbol({ name, SymbolUsage::Address, currCodeAddr() });
 
 		m_scopeList.push_back({ name });
+		m_scopePrefix.append(name).append(">>");
 	}
 
 	void Assembler::addFuncScope(const std::string& name)
@@ -1010,6 +1106,7 @@ namespace MarC
 			addSymbol({ "SCOPE_FUNC_LOCAL_SIZE", SymbolUsage::Value, mc });
 		}
 
+		m_scopePrefix.resize(m_scopePrefix.size() - m_scopeList.back().name.size() - 2);
 		m_scopeList.pop_back();
 	}
 
@@ -1018,22 +1115,24 @@ namespace MarC
 		if (name.find(">>") == 0)
 			return name;
 
-		std::string fullName = ">>";
-		for (auto& elem : m_scopeList)
-			fullName.append(elem.name + ">>");
-		fullName.append(name);
+		return m_scopePrefix + name;
+	}
+
+	SymbolID Assembler::getScopedID(std::string_view name)
+	{
+		if (name.find(">>") == 0)
+			return m_pModInfo->symbolNames.intern(name);
 
-		return fullName;
+		m_scopedNameBuffer.assign(m_scopePrefix).append(name);
+		return m_pModInfo->symbolNames.intern(m_scopedNameBuffer);
 	}
 
-	void Assembler::addSymbolAlias(SymbolAlias symAlias)
+	void Assembler::addSymbolAlias(const std::string& name, std::string_view refName)
 	{
-		symAlias.name = getScopedName(symAlias.name);
-		symAlias.refName = getScopedName(symAlias.refName);
-		m_pModInfo->symbolAliases.insert(symAlias);
+		m_pModInfo->symbolAliases.insert({ getScopedID(name), getScopedID(refName) });
 	}
 
-	bool Assembler::macroExists(const std::string& macroName)
+	bool Assembler::macroExists(std::string_view macroName)
 	{
 		return m_pModInfo->macros.find(macroName) != m_pModInfo->macros.end();
 	}
@@ -1049,36 +1148,32 @@ namespace MarC
 		if (macro.parameters.size() != parameters.size())
 			MARC_ASSEMBLER_THROW(AsmErrCode::PlainContext, "Parameter count mismatch for macro expansion!");
 
+		uint64_t expandedSize = macro.tokenList.size();
+		for (auto& slot : macro.paramSlots)
+			expandedSize += parameters[slot.paramIndex].size() - 1;
+
 		auto pTokenList = std::make_shared<AsmTokenList>();
+		pTokenList->reserve(expandedSize);
+		pTokenList->retain(macro.tokenList);
+		pTokenList->retain(*m_pCurrTokenList);
+		pTokenList->retain(m_pStringStore);
 
-		for (auto& token : macro.tokenList)
+		uint64_t nextCopied = 0;
+		for (auto& slot : macro.paramSlots)
 		{
-			uint64_t paramIndex = -1;
-			if (token.type == AsmToken::Type::Name)
-			{
-				for (uint64_t i = 0; i < macro.parameters.size(); ++i)
-				{
-					if (macro.parameters[i].value != token.value)
-						continue;
-					paramIndex = i;
-					break;
-				}
-			}
+			pTokenList->insert(pTokenList->end(), macro.tokenList.begin() + nextCopied, macro.tokenList.begin() + slot.tokenIndex);
 
-			if (paramIndex == (uint64_t)-1)
+			auto& slotToken = macro.tokenList[slot.tokenIndex];
+			for (AsmToken newToken : parameters[slot.paramIndex])
 			{
-				pTokenList->push_back(token);
-			}
-			else
-			{
-				for (AsmToken newToken : parameters[paramIndex])
-				{
-					newToken.line = token.line;
-					newToken.column = token.column;
-					pTokenList->push_back(newToken);
-				}
+				newToken.line = slotToken.line;
+				newToken.column = slotToken.column;
+				pTokenList->push_back(newToken);
 			}
+
+			nextCopied = slot.tokenIndex + 1;
 		}
+		pTokenList->insert(pTokenList->end(), macro.tokenList.begin() + nextCopied, macro.tokenList.end());
 
 		try
 		{
@@ -1090,9 +1185,9 @@ namespace MarC
 		}
 	}
 
-	void Assembler::addMacro(const std::string& macroName, const Macro& macro)
+	void Assembler::addMacro(const std::string& macroName, Macro&& macro)
 	{
-		m_pModInfo->macros.insert({ macroName, macro });
+		m_pModInfo->macros.insert({ macroName, std::move(macro) });
 	}
 
 	bool Assembler::isInstruction()
@@ -1136,10 +1231,9 @@ namespace MarC
 		auto& temp = currTokenNoModify();
 		if (temp.type == AsmToken::Type::Pragma_Insertion)
 		{
-			uint64_t index = std::stoull(temp.value);
-			if (index >= m_pragmaList.size())
-				MARC_ASSEMBLER_THROW(AsmErrCode::InvalidPragmaIndex, temp.value + "|" + std::to_string(m_pragmaList.size()));
-			return *(m_pragmaList.end() - 1 - index);
+			if (temp.pragmaIndex >= m_pragmaList.size())
+				MARC_ASSEMBLER_THROW(AsmErrCode::InvalidPragmaIndex, std::to_string(temp.pragmaIndex) + "|" + std::to_string(m_pragmaList.size()));
+			return *(m_pragmaList.end() - 1 - temp.pragmaIndex);
 		}
 		return temp;
 	}
@@ -1176,13 +1270,26 @@ namespace MarC
 		m_pModInfo->exeInfo->codeMemory.write(data, size, offset);
 	}
 
+	void Assembler::alignCode(uint64_t alignment)
+	{
+		static constexpr char padding[8] = { 0 };
+		uint64_t offset = currCodeOffset();
+		pushCode(padding, BC_AlignOffset(offset, alignment) - offset);
+	}
+
+	BC_CodeEncoding Assembler::codeEncoding() const
+	{
+		return m_pModInfo->exeInfo->codeEncoding;
+	}
+
 	uint64_t Assembler::currCodeOffset() const
 	{
 		return m_pModInfo->exeInfo->codeMemory.size();
 	}
 
-	BC_MemAddress Assembler::currCodeAddr() const
+	BC_MemAddress Assembler::currCodeAddr()
 	{
+		alignCode(BC_InstructionAlignment(codeEncoding()));
 		return BC_MemAddress(BC_MEM_BASE_CODE_MEMORY, currCodeOffset());
 	}
 
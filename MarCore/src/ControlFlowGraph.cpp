@@ -0,0 +1,307 @@
+#include "ControlFlowGraph.h"
+
+#include <algorithm>
+
+#include "Disassembler.h"
+
+namespace MarC
+{
+	static const BC_MemAddress RegStackPointer(BC_MEM_BASE_REGISTER, BC_MEM_REG_STACK_POINTER);
+	static const BC_MemAddress RegFramePointer(BC_MEM_BASE_REGISTER, BC_MEM_REG_FRAME_POINTER);
+
+	ControlFlowGraph::ControlFlowGraph(const std::vector<CodeInstruction>& code, uint64_t codeSize)
+		: m_codeSize(codeSize)
+	{
+		std::vector<bool> isLeader(code.size() + 1, false);
+		std::vector<bool> isAddressTaken(code.size() + 1, false);
+		isLeader[0] = true;
+
+		for (uint64_t i = 0; i < code.size(); ++i)
+		{
+			auto& daii = code[i].daii;
+			for (uint64_t j = 0; j < daii.args.size(); ++j)
+			{
+				if (!isCodeAddressArg(daii.args[j]))
+					continue;
+				uint64_t target = indexOf(code, codeSize, daii.args[j].value.cell.as_ADDR);
+				if (target == (uint64_t)-1)
+					continue;
+				isLeader[target] = true;
+				if (!isDirectTarget(daii, j))
+					isAddressTaken[target] = true;
+			}
+
+			if (isControlFlow(daii))
+				isLeader[i + 1] = true;
+		}
+
+		m_blockOf.resize(code.size());
+		for (uint64_t i = 0; i < code.size(); ++i)
+		{
+			if (isLeader[i])
+			{
+				if (!m_blocks.empty())
+					m_blocks.back().end = i;
+				BasicBlock block;
+				block.begin = i;
+				block.end = code.size();
+				block.addressTaken = isAddressTaken[i];
+				m_blocks.push_back(std::move(block));
+			}
+			m_blockOf[i] = m_blocks.size() - 1;
+		}
+
+		auto addEdge = [&](uint64_t from, uint64_t toIns) {
+			if (toIns >= code.size())
+				return;
+			uint64_t to = m_blockOf[toIns];
+			if (std::find(m_blocks[from].successors.begin(), m_blocks[from].successors.end(), to) != m_blocks[from].successors.end())
+				return;
+			m_blocks[from].successors.push_back(to);
+			m_blocks[to].predecessors.push_back(from);
+		};
+
+		for (uint64_t b = 0; b < m_blocks.size(); ++b)
+		{
+			auto& last = code[m_blocks[b].end - 1].daii;
+			if (!isControlFlow(last))
+			{
+				addEdge(b, m_blocks[b].end);
+				continue;
+			}
+
+			if (isJump(last.ocx.opCode) || last.ocx.opCode == BC_OC_CALL)
+			{
+				if (isDirectTarget(last, 0))
+					addEdge(b, indexOf(code, codeSize, last.args[0].value.cell.as_ADDR));
+				if (last.ocx.opCode != BC_OC_JUMP)
+					addEdge(b, m_blocks[b].end);
+			}
+		}
+	}
+
+	const std::vector<BasicBlock>& ControlFlowGraph::getBlocks() const
+	{
+		return m_blocks;
+	}
+
+	uint64_t ControlFlowGraph::blockOf(uint64_t insIndex) const
+	{
+		return m_blockOf[insIndex];
+	}
+
+	std::vector<bool> ControlFlowGraph::reachableBlocks() const
+	{
+		std::vector<bool> reachable(m_blocks.size(), false);
+		std::vector<uint64_t> pending;
+
+		for (uint64_t b = 0; b < m_blocks.size(); ++b)
+		{
+			if (b == 0 || m_blocks[b].addressTaken)
+			{
+				reachable[b] = true;
+				pending.push_back(b);
+			}
+		}
+
+		while (!pending.empty())
+		{
+			uint64_t b = pending.back();
+			pending.pop_back();
+			for (uint64_t succ : m_blocks[b].successors)
+			{
+				if (reachable[succ])
+					continue;
+				reachable[succ] = true;
+				pending.push_back(succ);
+			}
+		}
+
+		return reachable;
+	}
+
+	std::vector<int64_t> ControlFlowGraph::stackDepths(const std::vector<CodeInstruction>& code) const
+	{
+		static constexpr int64_t Unset = INT64_MIN;
+
+		std::vector<int64_t> depths(code.size(), UnknownStackDepth);
+		std::vector<int64_t> entryDepths(m_blocks.size(), Unset);
+		std::vector<uint64_t> pending;
+		if (m_blocks.empty())
+			return depths;
+
+		auto merge = [&](uint64_t block, int64_t depth) {
+			auto& entry = entryDepths[block];
+			if (entry == depth || entry == UnknownStackDepth)
+				return;
+			entry = entry == Unset ? depth : UnknownStackDepth;
+			pending.push_back(block);
+		};
+		auto mergeIns = [&](uint64_t insIndex, int64_t depth) {
+			if (insIndex < code.size())
+				merge(m_blockOf[insIndex], depth);
+		};
+
+		// The interpreter starts with '$sp' == '$fp', indirect jumps could come from anywhere.
+		merge(0, 0);
+		for (uint64_t b = 0; b < m_blocks.size(); ++b)
+		{
+			if (m_blocks[b].addressTaken)
+				merge(b, UnknownStackDepth);
+		}
+
+		while (!pending.empty())
+		{
+			uint64_t b = pending.back();
+			pending.pop_back();
+
+			auto& block = m_blocks[b];
+			int64_t depth = entryDepths[b];
+			for (uint64_t i = block.begin; i < block.end; ++i)
+			{
+				depths[i] = depth;
+				depth = applyStackEffect(code[i].daii, depth);
+			}
+
+			auto& last = code[block.end - 1].daii;
+			if (last.ocx.opCode == BC_OC_CALL)
+			{
+				// The callee's frame starts right behind its arguments.
+				if (isDirectTarget(last, 0))
+					mergeIns(indexOf(code, m_codeSize, last.args[0].value.cell.as_ADDR), callArgSize(last));
+				mergeIns(block.end, depth);
+			}
+			else if (isJump(last.ocx.opCode))
+			{
+				if (isDirectTarget(last, 0))
+					mergeIns(indexOf(code, m_codeSize, last.args[0].value.cell.as_ADDR), depth);
+				if (isConditionalJump(last.ocx.opCode))
+					mergeIns(block.end, depth);
+			}
+			else if (!isControlFlow(last))
+			{
+				mergeIns(block.end, depth);
+			}
+		}
+
+		return depths;
+	}
+
+	bool ControlFlowGraph::decode(const Memory& codeMemory, BC_CodeEncoding encoding, std::vector<CodeInstruction>& code)
+	{
+		code.clear();
+
+		uint64_t offset = 0;
+		while (offset < codeMemory.size())
+		{
+			auto daii = Disassembler::disassemble((const char*)codeMemory.getBaseAddress() + offset, encoding);
+			if (daii.ocx.opCode == BC_OC_NONE || daii.ocx.opCode >= BC_OC_NUM_OF_OP_CODES)
+				return false;
+			uint64_t size = daii.rawData.size();
+			code.push_back({ offset, std::move(daii) });
+			offset = BC_AlignOffset(offset + size, BC_InstructionAlignment(encoding));
+		}
+
+		return true;
+	}
+
+	uint64_t ControlFlowGraph::indexOf(const std::vector<CodeInstruction>& code, uint64_t codeSize, BC_MemAddress codeAddr)
+	{
+		if (codeAddr.base != BC_MEM_BASE_CODE_MEMORY || codeAddr.addr < 0)
+			return -1;
+		if ((uint64_t)codeAddr.addr == codeSize)
+			return code.size();
+
+		auto it = std::lower_bound(code.begin(), code.end(), (uint64_t)codeAddr.addr,
+			[](const CodeInstruction& ins, uint64_t offset) { return ins.offset < offset; });
+		if (it == code.end() || it->offset != (uint64_t)codeAddr.addr)
+			return -1;
+		return it - code.begin();
+	}
+
+	bool ControlFlowGraph::isJump(BC_OpCode oc)
+	{
+		return oc >= BC_OC_JUMP && oc <= BC_OC_JUMP_GREATER_EQUAL;
+	}
+
+	bool ControlFlowGraph::isConditionalJump(BC_OpCode oc)
+	{
+		return isJump(oc) && oc != BC_OC_JUMP;
+	}
+
+	bool ControlFlowGraph::isControlFlow(const DisAsmInsInfo& daii)
+	{
+		auto oc = daii.ocx.opCode;
+		if (isJump(oc) || oc == BC_OC_CALL || oc == BC_OC_RETURN || oc == BC_OC_EXIT)
+			return true;
+
+		if (daii.args.empty())
+			return false;
+		auto& dest = daii.args[0];
+		return dest.argType == InsArgType::Address && dest.derefCount == 0 &&
+			dest.value.cell.as_ADDR == BC_MemAddress(BC_MEM_BASE_REGISTER, BC_MEM_REG_CODE_POINTER);
+	}
+
+	bool ControlFlowGraph::isDirectTarget(const DisAsmInsInfo& daii, uint64_t argIndex)
+	{
+		return argIndex == 0 && (isJump(daii.ocx.opCode) || daii.ocx.opCode == BC_OC_CALL) &&
+			daii.args[0].derefCount == 0 && isCodeAddressArg(daii.args[0]);
+	}
+
+	bool ControlFlowGraph::isAddressArg(const DisAsmArg& arg)
+	{
+		if (arg.argType == InsArgType::None || arg.argType == InsArgType::Datatype)
+			return false;
+		return arg.derefCount > 0 || arg.value.datatype == BC_DT_ADDR;
+	}
+
+	bool ControlFlowGraph::isCodeAddressArg(const DisAsmArg& arg)
+	{
+		return isAddressArg(arg) && arg.value.cell.as_ADDR.base == BC_MEM_BASE_CODE_MEMORY;
+	}
+
+	uint64_t ControlFlowGraph::callArgSize(const DisAsmInsInfo& daii)
+	{
+		uint64_t size = 0;
+		for (uint64_t i = 1; i < daii.args.size(); ++i)
+			size += BC_DatatypeSize(daii.args[i].value.datatype);
+		return size;
+	}
+
+	int64_t ControlFlowGraph::applyStackEffect(const DisAsmInsInfo& daii, int64_t depth)
+	{
+		if (depth == UnknownStackDepth)
+			return depth;
+
+		if (!daii.args.empty())
+		{
+			auto& dest = daii.args[0];
+			if (dest.argType == InsArgType::Address && dest.derefCount == 0 && isAddressArg(dest) &&
+				(dest.value.cell.as_ADDR == RegStackPointer || dest.value.cell.as_ADDR == RegFramePointer))
+				return UnknownStackDepth;
+		}
+
+		switch (daii.ocx.opCode)
+		{
+		case BC_OC_PUSH:
+		case BC_OC_PUSH_COPY:
+			return depth + BC_DatatypeSize(daii.ocx.datatype);
+		case BC_OC_POP:
+		case BC_OC_POP_COPY:
+			return depth - BC_DatatypeSize(daii.ocx.datatype);
+		case BC_OC_PUSH_N_BYTES:
+			return daii.args[0].derefCount == 0 ? depth + daii.args[0].value.cell.as_I_64 : UnknownStackDepth;
+		case BC_OC_POP_N_BYTES:
+			return daii.args[0].derefCount == 0 ? depth - daii.args[0].value.cell.as_I_64 : UnknownStackDepth;
+		case BC_OC_PUSH_FRAME:
+			return 0;
+		case BC_OC_POP_FRAME:
+			return UnknownStackDepth;
+		case BC_OC_CALL:
+			// Returning leaves the return value on the stack.
+			return depth + BC_DatatypeSize(daii.ocx.datatype);
+		default:
+			return depth;
+		}
+	}
+}
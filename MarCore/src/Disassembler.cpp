@@ -4,18 +4,34 @@
 
 namespace MarC
 {
-	Disassembler::InstructionParser::InstructionParser(const void* pInstruction)
-		: m_pInsOrig(pInstruction), m_pIns(pInstruction)
+	Disassembler::InstructionParser::InstructionParser(const void* pInstruction, BC_CodeEncoding encoding)
+		: m_pInsOrig(pInstruction), m_pIns(pInstruction), m_encoding(encoding)
 	{}
 
+	void Disassembler::InstructionParser::align(uint64_t size)
+	{
+		// Instructions start at a multiple of the operand alignment, so aligning relative to the instruction is enough.
+		m_pIns = (const char*)m_pInsOrig + BC_AlignOffset(insSize(), BC_OperandAlignment(m_encoding, size));
+	}
+
+	BC_MemAddress Disassembler::InstructionParser::readAddress()
+	{
+		if (m_encoding != BC_CodeEncoding::Compact)
+			return read<BC_MemAddress>();
+
+		auto addr = BC_ReadCompactAddress(m_pIns);
+		m_pIns = (const char*)m_pIns + BC_CompactAddressSize(*(const uint8_t*)m_pIns);
+		return addr;
+	}
+
 	uint64_t Disassembler::InstructionParser::insSize() const
 	{
 		return ((char*)m_pIns - (char*)m_pInsOrig);
 	}
 
-	DisAsmInsInfo Disassembler::disassemble(const void* pInstruction)
+	DisAsmInsInfo Disassembler::disassemble(const void* pInstruction, BC_CodeEncoding encoding)
 	{
-		InstructionParser ip(pInstruction);
+		InstructionParser ip(pInstruction, encoding);
 		DisAsmInsInfo daii;
 
 		daii.ocx = ip.read<BC_OpCodeEx>();
@@ -38,6 +54,53 @@ namespace MarC
 		return daii;
 	}
 
+	std::vector<char> Disassembler::paddedCode(const Memory& codeMemory)
+	{
+		// disassemble() doesn't know where the code ends, it reads from a copy with zeroed headroom instead.
+		std::vector<char> code(codeMemory.size() + MaxInstructionSize, 0);
+		memcpy(code.data(), codeMemory.getBaseAddress(), codeMemory.size());
+		return code;
+	}
+
+	DisAsmCheck Disassembler::disassembleChecked(const std::vector<char>& code, uint64_t codeSize, uint64_t offset, BC_CodeEncoding encoding, DisAsmInsInfo& daii)
+	{
+		const char* pIns = code.data() + offset;
+
+		BC_OpCodeEx ocx;
+		memcpy(&ocx, pIns, sizeof(ocx));
+		if (ocx.opCode == BC_OC_NONE || ocx.opCode == BC_OC_UNKNOWN || ocx.opCode >= BC_OC_NUM_OF_OP_CODES)
+			return DisAsmCheck::InvalidOpCode;
+		if (ocx.datatype > BC_DT_ADDR)
+			return DisAsmCheck::InvalidDatatype;
+
+		if (ocx.opCode == BC_OC_CALL || ocx.opCode == BC_OC_CALL_EXTERN)
+		{
+			// Like in disassembleSpecCall/disassembleSpecCallExtern, the call data directly follows the function address.
+			uint64_t fcdOffset = BC_AlignOffset(sizeof(BC_OpCodeEx), BC_OperandAlignment(encoding, sizeof(BC_MemAddress)));
+			fcdOffset += encoding == BC_CodeEncoding::Compact ? BC_CompactAddressSize((uint8_t)pIns[fcdOffset]) : sizeof(BC_MemAddress);
+			fcdOffset = BC_AlignOffset(fcdOffset, BC_OperandAlignment(encoding, sizeof(BC_FuncCallData)));
+
+			BC_FuncCallData fcd;
+			memcpy(&fcd, pIns + fcdOffset, sizeof(fcd));
+
+			// The argument types have room for eight arguments.
+			if (fcd.nArgs > 8)
+				return DisAsmCheck::InvalidDatatype;
+			for (uint8_t i = 0; i < fcd.nArgs; ++i)
+			{
+				auto dt = fcd.argType.get(i);
+				if (dt < BC_DT_I_8 || dt > BC_DT_ADDR)
+					return DisAsmCheck::InvalidDatatype;
+			}
+		}
+
+		daii = disassemble(pIns, encoding);
+		if (offset + daii.rawData.size() > codeSize)
+			return DisAsmCheck::Truncated;
+
+		return DisAsmCheck::Ok;
+	}
+
 	void Disassembler::disassembleArgument(DisAsmInsInfo& daii, InstructionParser& ip, const InsArgument& arg)
 	{
 		DisAsmArg daa;
@@ -70,6 +133,9 @@ namespace MarC
 		case InsArgType::Datatype: daa.value.datatype = BC_DT_DATATYPE; break;
 		}
 
+		ip.align(BC_DatatypeSize(daa.derefCount ? BC_DT_ADDR : daa.value.datatype));
+		daa.offset = ip.insSize();
+
 		switch (daa.derefCount ? BC_DT_ADDR : daa.value.datatype)
 		{
 		case BC_DT_NONE: break;
@@ -84,7 +150,7 @@ namespace MarC
 		case BC_DT_U_64: daa.value.cell.as_U_64 = ip.read<uint64_t>(); break;
 		case BC_DT_F_32: daa.value.cell.as_F_32 = ip.read<float>(); break;
 		case BC_DT_F_64: daa.value.cell.as_F_64 = ip.read<double>(); break;
-		case BC_DT_ADDR: daa.value.cell.as_ADDR = ip.read<BC_MemAddress>(); break;
+		case BC_DT_ADDR: daa.value.cell.as_ADDR = ip.readAddress(); break;
 		case BC_DT_DATATYPE: daa.value.cell.as_Datatype = ip.read<BC_Datatype>(); break;
 		}
 
@@ -119,11 +185,12 @@ namespace MarC
 		uint64_t argIndex = 0;
 		daii.args.push_back(disassembleArgValue(daii, ip, { InsArgType::Address, BC_DT_NONE, argIndex++ }));
 
+		// Like the interpreter, the argument types come before the return value's destination.
+		const BC_FuncCallData& fcd = ip.read<BC_FuncCallData>();
+
 		if (daii.ocx.datatype != BC_DT_NONE)
 			disassembleArgument(daii, ip, { InsArgType::Address, daii.ocx.datatype, argIndex++ });
 
-		const BC_FuncCallData& fcd = ip.read<BC_FuncCallData>();
-
 		for (uint8_t i = 0; i < fcd.nArgs; ++i)
 			disassembleArgument(daii, ip, { InsArgType::TypedValue, fcd.argType.get(i), argIndex + i });
 	}
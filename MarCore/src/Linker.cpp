@@ -1,5 +1,8 @@
 #include "Linker.h"
 
+#include <cstring>
+#include <algorithm>
+
 #include "fileio/ModuleLocator.h"
 
 namespace MarC
@@ -8,14 +11,39 @@ namespace MarC
 		: m_modInfo(modInfo)
 	{}
 
+	Linker::Linker(const std::vector<ModuleInfoRef>& objects)
+		: m_modInfo(ModuleInfo::create())
+	{
+		if (objects.empty())
+			return;
+
+		std::map<std::string, const ModuleInfo*> objByName;
+		for (auto& object : objects)
+			objByName.insert({ object->exeInfo->name, object.get() });
+
+		std::set<std::string> placed;
+		addObject(*objects.back(), objByName, placed);
+		m_modInfo->exeInfo->name = objects.back()->exeInfo->name;
+	}
+
 	bool Linker::link()
 	{
 		resetError();
 
 		try
 		{
+			if (!m_missingObject.empty())
+				throw LinkerError(LinkErrCode::ModuleNotFound, m_missingObject);
+			if (!m_encodingMismatch.empty())
+				throw LinkerError(LinkErrCode::EncodingMismatch, m_encodingMismatch);
+			if (!m_compactOverflow.empty())
+				throw LinkerError(LinkErrCode::CompactAddressOverflow, m_compactOverflow);
 			resolveSymbolAliases();
 			resolveUnresolvedSymbolRefs();
+
+			// Assembly is done, the final images don't need the growth headroom anymore
+			m_modInfo->exeInfo->codeMemory.shrinkToFit();
+			m_modInfo->exeInfo->staticStack.shrinkToFit();
 		}
 		catch (LinkerError& err)
 		{
@@ -30,65 +58,227 @@ namespace MarC
 		return m_modInfo->exeInfo;
 	}
 
+	void Linker::addObject(const ModuleInfo& object, const std::map<std::string, const ModuleInfo*>& objects, std::set<std::string>& placed)
+	{
+		auto& exeInfo = *m_modInfo->exeInfo;
+		auto& objExeInfo = *object.exeInfo;
+		placed.insert(objExeInfo.name);
+
+		if (exeInfo.codeMemory.size() == 0 && exeInfo.staticStack.size() == 0)
+			exeInfo.codeEncoding = objExeInfo.codeEncoding;
+		else if (exeInfo.codeEncoding != objExeInfo.codeEncoding && m_encodingMismatch.empty())
+			m_encodingMismatch = objExeInfo.name;
+
+		uint64_t staticBase = exeInfo.staticStack.size();
+		exeInfo.staticStack.push(objExeInfo.staticStack.getBaseAddress(), objExeInfo.staticStack.size());
+
+		// The object's code gets split at its requests, segment i starts at segmentBegins[i] in the object and at segmentBases[i] in the executable.
+		std::vector<uint64_t> segmentBegins = { 0 };
+		std::vector<uint64_t> segmentBases;
+		auto& objCode = objExeInfo.codeMemory;
+		for (uint64_t i = 0; i <= object.requiredModules.size(); ++i)
+		{
+			uint64_t segmentEnd = i < object.requiredModules.size() ? object.requiredModuleOffsets[i] : objCode.size();
+
+			// Every segment starts at an instruction boundary.
+			static constexpr char padding[8] = { 0 };
+			uint64_t codeSize = exeInfo.codeMemory.size();
+			exeInfo.codeMemory.push(padding, BC_AlignOffset(codeSize, BC_InstructionAlignment(exeInfo.codeEncoding)) - codeSize);
+
+			segmentBases.push_back(exeInfo.codeMemory.size());
+			exeInfo.codeMemory.push((const char*)objCode.getBaseAddress() + segmentBegins.back(), segmentEnd - segmentBegins.back());
+			if (i == object.requiredModules.size())
+				break;
+			segmentBegins.push_back(segmentEnd);
+
+			auto& modName = object.requiredModules[i];
+			if (placed.find(modName) != placed.end())
+				continue;
+			auto itObj = objects.find(modName);
+			if (itObj == objects.end())
+			{
+				if (m_missingObject.empty())
+					m_missingObject = modName;
+				continue;
+			}
+			addObject(*itObj->second, objects, placed);
+		}
+
+		// Code at a request offset (e.g. a label right in front of '#reqmod') belongs to the segment behind the required module.
+		auto relocateOffset = [&](uint64_t offset) {
+			uint64_t segment = std::upper_bound(segmentBegins.begin(), segmentBegins.end(), offset) - segmentBegins.begin() - 1;
+			return segmentBases[segment] + offset - segmentBegins[segment];
+		};
+		auto relocate = [&](BC_MemAddress& addr) {
+			if (addr.base == BC_MEM_BASE_CODE_MEMORY && addr.addr >= 0)
+				addr.addr = relocateOffset(addr.addr);
+			else if (addr.base == BC_MEM_BASE_STATIC_STACK)
+				addr.addr += staticBase;
+		};
+
+		char* code = (char*)exeInfo.codeMemory.getBaseAddress();
+		bool isCompact = objExeInfo.codeEncoding == BC_CodeEncoding::Compact;
+		for (uint64_t objOffset : object.codeRelocations)
+		{
+			uint64_t offset = relocateOffset(objOffset);
+			char* pAddr = code + offset;
+			BC_MemAddress addr;
+			if (isCompact)
+				addr = BC_ReadCompactAddress(pAddr);
+			else
+				memcpy(&addr, pAddr, sizeof(addr));
+			relocate(addr);
+			if (isCompact)
+			{
+				if (!BC_PatchCompactAddress(pAddr, addr))
+					m_compactOverflow = BC_MemAddressToString(addr);
+			}
+			else
+			{
+				memcpy(pAddr, &addr, sizeof(addr));
+			}
+			m_modInfo->codeRelocations.push_back(offset);
+		}
+
+		for (auto symbol : objExeInfo.symbols)
+		{
+			if (symbol.usage == SymbolUsage::Address)
+				relocate(symbol.value.as_ADDR);
+			m_modInfo->defineSymbol(m_modInfo->symbolNames.intern(symbol.name), symbol);
+		}
+
+		for (auto& alias : object.symbolAliases)
+		{
+			m_modInfo->symbolAliases.insert({
+				m_modInfo->symbolNames.intern(object.symbolNames.name(alias.id)),
+				m_modInfo->symbolNames.intern(object.symbolNames.name(alias.refID))
+			});
+		}
+
+		for (auto& ref : object.unresolvedSymbolRefs)
+			m_modInfo->unresolvedSymbolRefs.push_back({ m_modInfo->symbolNames.intern(object.symbolNames.name(ref.id)), relocateOffset(ref.offset), ref.datatype });
+
+		exeInfo.mandatoryPermissions.insert(objExeInfo.mandatoryPermissions.begin(), objExeInfo.mandatoryPermissions.end());
+		exeInfo.optionalPermissions.insert(objExeInfo.optionalPermissions.begin(), objExeInfo.optionalPermissions.end());
+		exeInfo.requiredExtensions.insert(objExeInfo.requiredExtensions.begin(), objExeInfo.requiredExtensions.end());
+	}
+
 	void Linker::resolveSymbolAliases()
 	{
-		uint64_t nResolved;
+		auto& aliases = m_modInfo->symbolAliases;
+		if (aliases.empty())
+			return;
 
-		do
+		// Alias graph: every alias points to exactly one other name, so each chain is walked once
+		// from its first unvisited alias down to a defined symbol, an undefined name or a cycle.
+		std::vector<SymbolID> aliasRef(m_modInfo->symbolNames.size(), InvalidSymbolID);
+		for (auto& alias : aliases)
+			aliasRef[alias.id] = alias.refID;
+
+		enum class State : uint8_t { Unvisited, InProgress, Done };
+		std::vector<State> states(aliasRef.size(), State::Unvisited);
+		std::vector<SymbolID> chain;
+
+		for (auto& alias : aliases)
 		{
-			nResolved = 0;
+			if (states[alias.id] != State::Unvisited)
+				continue;
 
-			auto it = m_modInfo->symbolAliases.begin();
+			SymbolID curr = alias.id;
+			while (true)
+			{
+				states[curr] = State::InProgress;
+				chain.push_back(curr);
 
-			while (it != m_modInfo->symbolAliases.end())
+				SymbolID next = aliasRef[curr];
+				if (m_modInfo->findSymbol(next) || aliasRef[next] == InvalidSymbolID || states[next] == State::Done)
+					break;
+
+				if (states[next] == State::InProgress)
+				{
+					std::string cycleString;
+					auto itCycle = std::find(chain.begin(), chain.end(), next);
+					for (; itCycle != chain.end(); ++itCycle)
+						cycleString.append(m_modInfo->symbolNames.name(*itCycle) + " -> ");
+					cycleString.append(m_modInfo->symbolNames.name(next));
+					throw LinkerError(LinkErrCode::AliasCycle, cycleString);
+				}
+
+				curr = next;
+			}
+
+			// Resolve the chain back to front, each alias copies the symbol it points to.
+			for (auto it = chain.rbegin(); it != chain.rend(); ++it)
 			{
-				auto current = it++;
+				states[*it] = State::Done;
 
-				auto itRef = m_modInfo->exeInfo->symbols.find(current->refName);
-				if (itRef == m_modInfo->exeInfo->symbols.end())
+				auto pRef = m_modInfo->findSymbol(aliasRef[*it]);
+				if (!pRef)
 					continue;
 
 				Symbol sym;
-				sym.name = current->name;
-				sym.usage = itRef->usage;
-				sym.value = itRef->value;
-
-				m_modInfo->exeInfo->symbols.insert(sym);
+				sym.name = m_modInfo->symbolNames.name(*it);
+				sym.usage = pRef->usage;
+				sym.value = pRef->value;
 
-				m_modInfo->symbolAliases.erase(current);
-
-				++nResolved;
+				m_modInfo->defineSymbol(*it, sym);
 			}
+			chain.clear();
+		}
+
+		// Aliases that point to undefined names stay for the next link.
+		auto it = aliases.begin();
+		while (it != aliases.end())
+		{
+			if (m_modInfo->findSymbol(it->refID))
+				it = aliases.erase(it);
+			else
+				++it;
 		}
-		while (nResolved != 0);
 	}
 
 	void Linker::resolveUnresolvedSymbolRefs()
 	{
-		bool resolvedAll = true;
+		auto& codeMemory = m_modInfo->exeInfo->codeMemory;
+		char* codeBase = (char*)codeMemory.getBaseAddress();
+		uint64_t codeSize = codeMemory.size();
 
-		for (uint64_t i = 0; i < m_modInfo->unresolvedSymbolRefs.size(); ++i)
+		// Patch all resolvable references in one pass, the remaining ones are kept for the next link.
+		std::vector<SymbolRef> unresolved;
+		for (auto& ref : m_modInfo->unresolvedSymbolRefs)
 		{
-			auto& ref = m_modInfo->unresolvedSymbolRefs[i];
-			auto result = m_modInfo->exeInfo->symbols.find(ref.name);
-			if (result == m_modInfo->exeInfo->symbols.end())
+			auto result = m_modInfo->findSymbol(ref.id);
+			if (!result)
+			{
+				unresolved.push_back(ref);
 				continue;
+			}
 
-			m_modInfo->exeInfo->codeMemory.write(&result->value, BC_DatatypeSize(ref.datatype), ref.offset);
+			if (ref.datatype == BC_DT_ADDR && m_modInfo->exeInfo->codeEncoding == BC_CodeEncoding::Compact)
+			{
+				if (!BC_PatchCompactAddress(codeBase + ref.offset, result->value.as_ADDR))
+					throw LinkerError(LinkErrCode::CompactAddressOverflow, m_modInfo->symbolNames.name(ref.id));
+				continue;
+			}
 
-			m_modInfo->unresolvedSymbolRefs.erase(m_modInfo->unresolvedSymbolRefs.begin() + i);
-			--i;
+			uint64_t size = BC_DatatypeSize(ref.datatype);
+			if (ref.offset + size <= codeSize)
+				memcpy(codeBase + ref.offset, &result->value, size);
+			else
+			{
+				codeMemory.write(&result->value, size, ref.offset);
+				codeBase = (char*)codeMemory.getBaseAddress();
+				codeSize = codeMemory.size();
+			}
 		}
+		m_modInfo->unresolvedSymbolRefs.swap(unresolved);
 
 		if (!m_modInfo->unresolvedSymbolRefs.empty())
-			resolvedAll = false;
-
-		if (!resolvedAll)
 		{
 			std::string unresString;
 			for (uint64_t i = 0; i < m_modInfo->unresolvedSymbolRefs.size(); ++i)
 			{
-				unresString.append(m_modInfo->unresolvedSymbolRefs[i].name);
+				unresString.append(m_modInfo->symbolNames.name(m_modInfo->unresolvedSymbolRefs[i].id));
 				if (i + 1 < m_modInfo->unresolvedSymbolRefs.size())
 					unresString.append(", ");
 			}
@@ -98,9 +288,12 @@ namespace MarC
 
 	bool Linker::symbolNameExists(const std::string& name)
 	{
-		if (m_modInfo->exeInfo->symbols.find(Symbol(name)) != m_modInfo->exeInfo->symbols.end())
+		SymbolID id = m_modInfo->symbolNames.find(name);
+		if (id == InvalidSymbolID)
+			return false;
+		if (m_modInfo->findSymbol(id))
 			return true;
-		if (m_modInfo->symbolAliases.find(SymbolAlias(name, "")) != m_modInfo->symbolAliases.end())
+		if (m_modInfo->symbolAliases.find(SymbolAlias(id, InvalidSymbolID)) != m_modInfo->symbolAliases.end())
 			return true;
 		return false;
 	}
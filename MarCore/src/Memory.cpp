@@ -1,6 +1,7 @@
 #include "Memory.h"
 
 #include <cstring>
+#include <algorithm>
 
 namespace MarC
 {
@@ -52,12 +53,33 @@ namespace MarC
 		if (!m_resizable)
 			return false;
 
-		uint64_t newSizePadded = (newSize + 7) / 8 * 8;
-		m_data.reserve(newSizePadded);
+		if (newSize > m_data.capacity())
+		{
+			// Grow geometrically, data gets pushed piece by piece during assembly
+			uint64_t newCapacity = std::max(paddedSize(newSize), (uint64_t)m_data.capacity() * 2);
+			m_data.reserve(newCapacity);
+		}
 		m_data.resize(newSize);
 		return true;
 	}
 
+	void Memory::shrinkToFit()
+	{
+		uint64_t capacity = paddedSize(m_data.size());
+		if (m_data.capacity() <= capacity)
+			return;
+
+		std::vector<char> data;
+		data.reserve(capacity);
+		data.assign(m_data.begin(), m_data.end());
+		m_data.swap(data);
+	}
+
+	uint64_t Memory::paddedSize(uint64_t size)
+	{
+		return (size + 7) / 8 * 8;
+	}
+
 	bool Memory::autoResize(uint64_t newSize)
 	{
 		if (newSize < m_data.size())
@@ -1,5 +1,7 @@
 #include "ModuleInfo.h"
 
+#include "errors/MarCoreError.h"
+
 namespace MarC
 {
 	ModuleInfo::ModuleInfo()
@@ -7,6 +9,23 @@ namespace MarC
 		exeInfo = ExecutableInfo::create();
 	}
 
+	void ModuleInfo::defineSymbol(SymbolID id, const Symbol& symbol)
+	{
+		if (id >= symbolsByID.size())
+			symbolsByID.resize(symbolNames.size(), nullptr);
+		if (symbolsByID[id])
+			return;
+
+		symbolsByID[id] = &*exeInfo->symbols.insert(symbol).first;
+	}
+
+	const Symbol* ModuleInfo::findSymbol(SymbolID id) const
+	{
+		if (id >= symbolsByID.size())
+			return nullptr;
+		return symbolsByID[id];
+	}
+
 	void ModuleInfo::backup()
 	{
 		bud.symAliases = symbolAliases.size();
@@ -21,4 +40,171 @@ namespace MarC
 	{
 		return std::make_shared<ModuleInfo>();
 	}
+
+	struct ObjectHeader
+	{
+		char magic[8] = { 'M', 'A', 'R', 'C', 'O', 'B', 'J', '\0' };
+		uint64_t version = 2;
+	};
+	MARC_SERIALIZER_ENABLE_FIXED(ObjectHeader);
+
+	static void serializeToken(const AsmToken& token, std::ostream& oStream)
+	{
+		serialize(token.line, oStream);
+		serialize(token.column, oStream);
+		serializeStaticSized(token.type, oStream);
+		serialize(token.pragmaIndex, oStream);
+		serialize(std::string(token.value), oStream);
+	}
+
+	static void deserializeToken(AsmToken& token, AsmStringStore& store, std::istream& iStream)
+	{
+		std::string value;
+		deserialize(token.line, iStream);
+		deserialize(token.column, iStream);
+		deserializeStaticSized(token.type, iStream);
+		deserialize(token.pragmaIndex, iStream);
+		deserialize(value, iStream);
+		token.value = store.intern(std::move(value));
+	}
+
+	template <>
+	void serialize(const ModuleInfo& modInfo, std::ostream& oStream)
+	{
+		serialize(ObjectHeader(), oStream);
+		serialize(*modInfo.exeInfo, oStream);
+
+		serialize<uint64_t>(modInfo.symbolNames.size(), oStream);
+		for (SymbolID id = 0; id < modInfo.symbolNames.size(); ++id)
+			serialize(modInfo.symbolNames.name(id), oStream);
+
+		serialize<uint64_t>(modInfo.symbolAliases.size(), oStream);
+		for (auto& alias : modInfo.symbolAliases)
+		{
+			serialize(alias.id, oStream);
+			serialize(alias.refID, oStream);
+		}
+
+		serialize<uint64_t>(modInfo.unresolvedSymbolRefs.size(), oStream);
+		for (auto& ref : modInfo.unresolvedSymbolRefs)
+		{
+			serialize(ref.id, oStream);
+			serialize(ref.offset, oStream);
+			serializeStaticSized(ref.datatype, oStream);
+		}
+
+		serialize<uint64_t>(modInfo.codeRelocations.size(), oStream);
+		for (auto offset : modInfo.codeRelocations)
+			serialize(offset, oStream);
+
+		serialize(modInfo.requiredModules, oStream);
+		for (auto offset : modInfo.requiredModuleOffsets)
+			serialize(offset, oStream);
+		serialize(modInfo.sourceHash, oStream);
+		serialize(modInfo.interfaceHash, oStream);
+
+		serialize<uint64_t>(modInfo.macros.size() - modInfo.importedMacros.size(), oStream);
+		for (auto& [name, macro] : modInfo.macros)
+		{
+			if (modInfo.importedMacros.find(name) != modInfo.importedMacros.end())
+				continue;
+
+			serialize(name, oStream);
+			serialize<uint64_t>(macro.parameters.size(), oStream);
+			for (auto& param : macro.parameters)
+				serializeToken(param, oStream);
+			serialize<uint64_t>(macro.tokenList.size(), oStream);
+			for (auto& token : macro.tokenList)
+				serializeToken(token, oStream);
+			serialize<uint64_t>(macro.paramSlots.size(), oStream);
+			for (auto& slot : macro.paramSlots)
+			{
+				serialize(slot.tokenIndex, oStream);
+				serialize(slot.paramIndex, oStream);
+			}
+		}
+	}
+
+	template <>
+	void deserialize(ModuleInfo& modInfo, std::istream& iStream)
+	{
+		modInfo = ModuleInfo();
+
+		ObjectHeader header;
+		deserialize(header, iStream);
+		if (std::string(header.magic) != ObjectHeader().magic || header.version != ObjectHeader().version)
+			throw MarCoreError("ObjectLoadError", "The file is not a compatible MarC object!");
+
+		deserialize(*modInfo.exeInfo, iStream);
+
+		uint64_t count;
+		deserialize(count, iStream);
+		for (uint64_t i = 0; i < count; ++i)
+		{
+			std::string name;
+			deserialize(name, iStream);
+			modInfo.symbolNames.intern(name);
+		}
+		for (auto& symbol : modInfo.exeInfo->symbols)
+			modInfo.defineSymbol(modInfo.symbolNames.intern(symbol.name), symbol);
+
+		deserialize(count, iStream);
+		for (uint64_t i = 0; i < count; ++i)
+		{
+			SymbolAlias alias;
+			deserialize(alias.id, iStream);
+			deserialize(alias.refID, iStream);
+			modInfo.symbolAliases.insert(alias);
+		}
+
+		deserialize(count, iStream);
+		modInfo.unresolvedSymbolRefs.resize(count);
+		for (auto& ref : modInfo.unresolvedSymbolRefs)
+		{
+			deserialize(ref.id, iStream);
+			deserialize(ref.offset, iStream);
+			deserializeStaticSized(ref.datatype, iStream);
+		}
+
+		deserialize(count, iStream);
+		modInfo.codeRelocations.resize(count);
+		for (auto& offset : modInfo.codeRelocations)
+			deserialize(offset, iStream);
+
+		deserialize(modInfo.requiredModules, iStream);
+		modInfo.requiredModuleOffsets.resize(modInfo.requiredModules.size());
+		for (auto& offset : modInfo.requiredModuleOffsets)
+			deserialize(offset, iStream);
+		deserialize(modInfo.sourceHash, iStream);
+		deserialize(modInfo.interfaceHash, iStream);
+
+		auto pStore = std::make_shared<AsmStringStore>();
+		deserialize(count, iStream);
+		for (uint64_t i = 0; i < count && iStream.good(); ++i)
+		{
+			std::string name;
+			Macro macro;
+			macro.tokenList.retain(pStore);
+
+			uint64_t n;
+			deserialize(name, iStream);
+			deserialize(n, iStream);
+			macro.parameters.resize(n);
+			for (auto& param : macro.parameters)
+				deserializeToken(param, *pStore, iStream);
+			deserialize(n, iStream);
+			macro.tokenList.resize(n);
+			for (auto& token : macro.tokenList)
+				deserializeToken(token, *pStore, iStream);
+			deserialize(n, iStream);
+			macro.paramSlots.resize(n);
+			for (auto& slot : macro.paramSlots)
+			{
+				deserialize(slot.tokenIndex, iStream);
+				deserialize(slot.paramIndex, iStream);
+			}
+
+			modInfo.macros.insert({ name, std::move(macro) });
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,1229 @@
+#include "Optimizer.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace MarC
+{
+	typedef ControlFlowGraph CFG;
+
+	static const BC_MemAddress RegCodePointer(BC_MEM_BASE_REGISTER, BC_MEM_REG_CODE_POINTER);
+	static const BC_MemAddress RegStackPointer(BC_MEM_BASE_REGISTER, BC_MEM_REG_STACK_POINTER);
+	static const BC_MemAddress RegFramePointer(BC_MEM_BASE_REGISTER, BC_MEM_REG_FRAME_POINTER);
+	static const BC_MemAddress RegTemporaryData(BC_MEM_BASE_REGISTER, BC_MEM_REG_TEMPORARY_DATA);
+
+	static bool isStackOp(BC_OpCode oc)
+	{
+		return oc >= BC_OC_PUSH && oc <= BC_OC_POP_FRAME;
+	}
+
+	// Writes the opcode and the arguments of 'daii' to its raw data and updates the offsets of the arguments.
+	static void encodeOperands(BC_CodeEncoding encoding, DisAsmInsInfo& daii)
+	{
+		auto& rawData = daii.rawData;
+		rawData.resize(sizeof(BC_OpCodeEx));
+		memcpy(rawData.data(), &daii.ocx, sizeof(BC_OpCodeEx));
+
+		auto push = [&](const void* data, uint64_t size) {
+			uint64_t offset = BC_AlignOffset(rawData.size(), BC_OperandAlignment(encoding, size));
+			rawData.resize(offset, 0);
+			rawData.insert(rawData.end(), (const char*)data, (const char*)data + size);
+			return offset;
+		};
+
+		for (uint64_t i = 0; i < daii.args.size(); ++i)
+		{
+			auto& arg = daii.args[i];
+			if (encoding == BC_CodeEncoding::Compact && CFG::isAddressArg(arg))
+			{
+				auto addr = arg.value.cell.as_ADDR;
+				bool isRelocated = addr.base == BC_MEM_BASE_CODE_MEMORY || addr.base == BC_MEM_BASE_STATIC_STACK;
+				char buffer[sizeof(BC_MemAddress) + 1];
+				arg.offset = push(buffer, BC_WriteCompactAddress(buffer, addr, isRelocated ? BC_CAW_32 : BC_CompactAddressWidth(addr)));
+			}
+			else
+			{
+				uint64_t size = arg.derefCount > 0 ? sizeof(BC_MemAddress) : BC_DatatypeSize(arg.value.datatype);
+				arg.offset = push(&arg.value.cell, size);
+			}
+
+			// The argument types of calls follow the function address.
+			if (i == 0 && (daii.ocx.opCode == BC_OC_CALL || daii.ocx.opCode == BC_OC_CALL_EXTERN))
+			{
+				uint64_t firstArg = daii.ocx.opCode == BC_OC_CALL_EXTERN && daii.ocx.datatype != BC_DT_NONE ? 2 : 1;
+				BC_FuncCallData fcd;
+				for (uint64_t j = firstArg; j < daii.args.size(); ++j)
+					fcd.argType.set(fcd.nArgs++, daii.args[j].value.datatype);
+				push(&fcd, sizeof(fcd));
+			}
+		}
+	}
+
+	static CodeInstruction encodeInstruction(BC_CodeEncoding encoding, BC_OpCodeEx ocx, std::vector<DisAsmArg> args)
+	{
+		for (uint64_t i = 0; i < args.size(); ++i)
+			ocx.derefArg.set(i, args[i].derefCount);
+
+		CodeInstruction ins;
+		ins.daii.ocx = ocx;
+		ins.daii.args = std::move(args);
+		encodeOperands(encoding, ins.daii);
+
+		return ins;
+	}
+
+	static CodeInstruction encodeStackResize(BC_CodeEncoding encoding, BC_OpCode oc, uint64_t nBytes)
+	{
+		BC_OpCodeEx ocx;
+		ocx.opCode = oc;
+		DisAsmArg arg;
+		arg.argType = InsArgType::TypedValue;
+		arg.value.datatype = BC_DT_U_64;
+		arg.value.cell.as_U_64 = nBytes;
+		return encodeInstruction(encoding, ocx, { arg });
+	}
+
+	// Copies the value of a call argument, e.g. 'pushc.dt : value' or 'mov.dt : dest : value'.
+	static CodeInstruction encodeArgCopy(BC_CodeEncoding encoding, BC_OpCode oc, std::vector<DisAsmArg> args, const DisAsmArg& value)
+	{
+		BC_OpCodeEx ocx;
+		ocx.opCode = oc;
+		ocx.datatype = value.value.datatype;
+		args.push_back(value);
+		args.back().argType = InsArgType::Value;
+		return encodeInstruction(encoding, ocx, std::move(args));
+	}
+
+	// Size of the instruction including the padding in front of the next one.
+	static uint64_t paddedSize(BC_CodeEncoding encoding, const CodeInstruction& ins)
+	{
+		return BC_AlignOffset(ins.daii.rawData.size(), BC_InstructionAlignment(encoding));
+	}
+
+	static DisAsmArg frameAddressArg(int64_t offset)
+	{
+		DisAsmArg arg;
+		arg.argType = InsArgType::Address;
+		arg.value.datatype = BC_DT_ADDR;
+		arg.value.cell.as_ADDR = BC_MemAddress(BC_MEM_BASE_DYNAMIC_FRAME, offset);
+		return arg;
+	}
+
+	static bool refersTo(const DisAsmArg& arg, BC_MemAddress addr)
+	{
+		return CFG::isAddressArg(arg) && arg.value.cell.as_ADDR == addr;
+	}
+
+	// Plain 64 bit integers can hold addresses as well (e.g. 'mov.u64 : $ac : SOME_LABEL'), those can't be relocated.
+	static bool mayHoldAddress(const DisAsmArg& arg, BC_MemBase base)
+	{
+		if (arg.argType != InsArgType::Value && arg.argType != InsArgType::TypedValue)
+			return false;
+		if (CFG::isAddressArg(arg) || arg.value.datatype == BC_DT_F_64 || BC_DatatypeSize(arg.value.datatype) != sizeof(BC_MemAddress))
+			return false;
+		return arg.value.cell.as_ADDR.base == base;
+	}
+
+	// Whether a call argument reads the same value no matter where the callee's frame ends up.
+	// 'depth' is the distance between '$sp' and '$fp' in front of the call.
+	static bool isFrameIndependentArg(const DisAsmArg& arg, int64_t depth)
+	{
+		if (mayHoldAddress(arg, BC_MEM_BASE_DYNAMIC_FRAME) || mayHoldAddress(arg, BC_MEM_BASE_DYNAMIC_STACK))
+			return false;
+		if (!CFG::isAddressArg(arg))
+			return true;
+
+		auto addr = arg.value.cell.as_ADDR;
+		if (addr == RegStackPointer || addr == RegFramePointer || addr.base == BC_MEM_BASE_DYNAMIC_STACK)
+			return false;
+		// Frame addresses passed as values are relative to the callee's frame pointer.
+		return addr.base != BC_MEM_BASE_DYNAMIC_FRAME || (arg.derefCount > 0 && addr.addr < depth);
+	}
+
+	// Whether the plain value 'arg' leaves the destination of 'oc' unchanged (x + 0, x * 1, ...).
+	static bool isIdentityOperand(BC_OpCode oc, BC_Datatype dt, const DisAsmArg& arg)
+	{
+		if (arg.derefCount > 0)
+			return false;
+
+		auto& cell = arg.value.cell;
+		bool isAdditive = oc == BC_OC_ADD || oc == BC_OC_SUBTRACT;
+		bool isMultiplicative = oc == BC_OC_MULTIPLY || oc == BC_OC_DIVIDE;
+		if (!isAdditive && !isMultiplicative)
+			return false;
+
+		switch (dt)
+		{
+		case BC_DT_I_8:  return cell.as_I_8 == (isAdditive ? 0 : 1);
+		case BC_DT_I_16: return cell.as_I_16 == (isAdditive ? 0 : 1);
+		case BC_DT_I_32: return cell.as_I_32 == (isAdditive ? 0 : 1);
+		case BC_DT_I_64: return cell.as_I_64 == (isAdditive ? 0 : 1);
+		case BC_DT_U_8:  return cell.as_U_8 == (isAdditive ? 0u : 1u);
+		case BC_DT_U_16: return cell.as_U_16 == (isAdditive ? 0u : 1u);
+		case BC_DT_U_32: return cell.as_U_32 == (isAdditive ? 0u : 1u);
+		case BC_DT_U_64: return cell.as_U_64 == (isAdditive ? 0u : 1u);
+		case BC_DT_ADDR: return cell.as_ADDR.addr == (isAdditive ? 0 : 1);
+		// x + 0.0 turns -0.0 into +0.0, only x + (-0.0) and x - 0.0 are exact.
+		case BC_DT_F_32:
+			if (isMultiplicative)
+				return cell.as_F_32 == 1.0f;
+			return cell.as_F_32 == 0.0f && std::signbit(cell.as_F_32) == (oc == BC_OC_ADD);
+		case BC_DT_F_64:
+			if (isMultiplicative)
+				return cell.as_F_64 == 1.0;
+			return cell.as_F_64 == 0.0 && std::signbit(cell.as_F_64) == (oc == BC_OC_ADD);
+		default:
+			return false;
+		}
+	}
+
+	template <typename T>
+	static bool compare(BC_OpCode oc, T left, T right)
+	{
+		switch (oc)
+		{
+		case BC_OC_JUMP_EQUAL: return left == right;
+		case BC_OC_JUMP_NOT_EQUAL: return left != right;
+		case BC_OC_JUMP_LESS_THAN: return left < right;
+		case BC_OC_JUMP_GREATER_THAN: return left > right;
+		case BC_OC_JUMP_LESS_EQUAL: return left <= right;
+		case BC_OC_JUMP_GREATER_EQUAL: return left >= right;
+		default: return false;
+		}
+	}
+
+	// Evaluates the condition of a conditional jump like the interpreter does.
+	// Addresses aren't folded, the optimizer itself changes the values of code addresses.
+	static bool evaluateCondition(BC_OpCode oc, BC_Datatype dt, const BC_MemCell& left, const BC_MemCell& right, bool& result)
+	{
+		switch (dt)
+		{
+		case BC_DT_I_8:  result = compare(oc, left.as_I_8, right.as_I_8); return true;
+		case BC_DT_I_16: result = compare(oc, left.as_I_16, right.as_I_16); return true;
+		case BC_DT_I_32: result = compare(oc, left.as_I_32, right.as_I_32); return true;
+		case BC_DT_I_64: result = compare(oc, left.as_I_64, right.as_I_64); return true;
+		case BC_DT_U_8:  result = compare(oc, left.as_U_8, right.as_U_8); return true;
+		case BC_DT_U_16: result = compare(oc, left.as_U_16, right.as_U_16); return true;
+		case BC_DT_U_32: result = compare(oc, left.as_U_32, right.as_U_32); return true;
+		case BC_DT_U_64: result = compare(oc, left.as_U_64, right.as_U_64); return true;
+		case BC_DT_F_32: result = compare(oc, left.as_F_32, right.as_F_32); return true;
+		case BC_DT_F_64: result = compare(oc, left.as_F_64, right.as_F_64); return true;
+		default: return false;
+		}
+	}
+
+	std::string OptimizerReportToString(const OptimizerReport& report)
+	{
+		if (!report.skipReason.empty())
+			return "Optimizer skipped the code: " + report.skipReason;
+
+		std::string str = "Optimized " + std::to_string(report.nInsBefore) + " -> " + std::to_string(report.nInsAfter) + " instructions, " +
+			std::to_string(report.codeSizeBefore) + " -> " + std::to_string(report.codeSizeAfter) + " bytes";
+		if (report.staticSizeBefore != report.staticSizeAfter)
+			str.append(", static data " + std::to_string(report.staticSizeBefore) + " -> " + std::to_string(report.staticSizeAfter) + " bytes");
+		for (auto& [rewrite, count] : report.rewrites)
+			str.append("\n  " + rewrite + ": " + std::to_string(count));
+		for (auto& site : report.inlinedCalls)
+			str.append("\n  inlined " + site);
+		return str;
+	}
+
+	Optimizer::Optimizer(ExecutableInfoRef exeInfo, uint64_t level)
+		: m_exeInfo(exeInfo), m_level(level)
+	{}
+
+	void Optimizer::setInlineLimit(uint64_t maxInstructions)
+	{
+		m_inlineLimit = maxInstructions;
+	}
+
+	void Optimizer::optimize()
+	{
+		m_report = OptimizerReport();
+		m_report.codeSizeBefore = m_report.codeSizeAfter = m_exeInfo->codeMemory.size();
+		m_report.staticSizeBefore = m_report.staticSizeAfter = m_exeInfo->staticStack.size();
+
+		if (!decode())
+			return;
+
+		m_report.nInsBefore = m_report.nInsAfter = m_code.size();
+		if (m_level == 0)
+			return;
+
+		runPasses();
+
+		// Inlined bodies and tail calls are cleaned up by another round, at level 2 that also drops functions without remaining calls.
+		bool changed = false;
+		if (m_inlineLimit > 0)
+			changed |= inlineCalls();
+		if (m_level >= 2)
+			changed |= eliminateTailCalls();
+		if (changed)
+			runPasses();
+
+		if (m_level >= 2)
+			removeUnusedStatics();
+
+		rebuild();
+	}
+
+	const OptimizerReport& Optimizer::getReport() const
+	{
+		return m_report;
+	}
+
+	bool Optimizer::decode()
+	{
+		if (!CFG::decode(m_exeInfo->codeMemory, m_exeInfo->codeEncoding, m_code))
+		{
+			uint64_t offset = m_code.empty() ? 0 : m_code.back().offset + m_code.back().daii.rawData.size();
+			m_report.skipReason = "Unknown instruction at " + BC_MemAddressToString(BC_MemAddress(BC_MEM_BASE_CODE_MEMORY, offset));
+			return false;
+		}
+		m_removed.assign(m_code.size(), false);
+		m_codeSize = m_exeInfo->codeMemory.size();
+
+		// Instructions can only be moved if every code address is known and points to the start of an instruction.
+		for (auto& ins : m_code)
+		{
+			for (uint64_t i = 0; i < ins.daii.args.size(); ++i)
+			{
+				auto& arg = ins.daii.args[i];
+				if (CFG::isCodeAddressArg(arg) && indexOf(arg.value.cell.as_ADDR) == (uint64_t)-1)
+				{
+					m_report.skipReason = "Code address " + BC_MemAddressToString(arg.value.cell.as_ADDR) + " doesn't point to an instruction";
+					return false;
+				}
+
+				if (mayHoldAddress(arg, BC_MEM_BASE_CODE_MEMORY))
+				{
+					m_report.skipReason = "Code address used as an integer at " + BC_MemAddressToString(BC_MemAddress(BC_MEM_BASE_CODE_MEMORY, ins.offset));
+					return false;
+				}
+
+				bool isWrite = i == 0 && arg.argType == InsArgType::Address && arg.derefCount == 0 &&
+					(ins.daii.ocx.opCode == BC_OC_MOVE || ins.daii.ocx.opCode == BC_OC_POP_COPY);
+				if (refersTo(arg, RegCodePointer) && !isWrite)
+				{
+					m_report.skipReason = "The code pointer is read at " + BC_MemAddressToString(BC_MemAddress(BC_MEM_BASE_CODE_MEMORY, ins.offset));
+					return false;
+				}
+			}
+		}
+
+		for (auto& symbol : m_exeInfo->symbols)
+		{
+			if (symbol.usage == SymbolUsage::Address && symbol.value.as_ADDR.base == BC_MEM_BASE_CODE_MEMORY && indexOf(symbol.value.as_ADDR) == (uint64_t)-1)
+			{
+				m_report.skipReason = "Symbol '" + symbol.name + "' doesn't point to an instruction";
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void Optimizer::runPasses()
+	{
+		bool changed = true;
+		while (changed)
+		{
+			collectTargets();
+
+			changed = false;
+			changed |= threadJumps();
+			changed |= removeJumpsToNext();
+			changed |= removeNoOps();
+			changed |= removeTempSaves();
+
+			if (m_level >= 2)
+			{
+				changed |= foldConstantBranches();
+				changed |= removeUnreachableCode();
+			}
+		}
+	}
+
+	void Optimizer::collectTargets()
+	{
+		m_targets.clear();
+		m_targets.insert(0);
+
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			if (m_removed[i])
+				continue;
+			for (auto& arg : m_code[i].daii.args)
+			{
+				if (CFG::isCodeAddressArg(arg))
+					m_targets.insert(indexOf(arg.value.cell.as_ADDR));
+			}
+		}
+
+		// Labels and functions stay entry points, the debugger and disassembler refer to them.
+		for (auto& symbol : m_exeInfo->symbols)
+		{
+			if (symbol.usage == SymbolUsage::Address && symbol.value.as_ADDR.base == BC_MEM_BASE_CODE_MEMORY)
+				m_targets.insert(indexOf(symbol.value.as_ADDR));
+		}
+	}
+
+	bool Optimizer::threadJumps()
+	{
+		bool changed = false;
+
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			auto& ins = m_code[i];
+			if (m_removed[i] || !CFG::isDirectTarget(ins.daii, 0))
+				continue;
+
+			uint64_t first = nextLive(indexOf(ins.daii.args[0].value.cell.as_ADDR));
+			uint64_t final = first;
+			std::set<uint64_t> visited;
+			bool isCycle = false;
+			while (final < m_code.size())
+			{
+				// Jumps that end up in a loop of jumps have no final target.
+				if (!visited.insert(final).second)
+				{
+					isCycle = true;
+					break;
+				}
+				auto& next = m_code[final].daii;
+				if (next.ocx.opCode != BC_OC_JUMP || !CFG::isDirectTarget(next, 0))
+					break;
+				final = nextLive(indexOf(next.args[0].value.cell.as_ADDR));
+			}
+
+			if (final == first || isCycle)
+				continue;
+
+			setArgValue(ins, 0, codeAddrOf(final));
+			++m_report.rewrites["jumps threaded"];
+			changed = true;
+		}
+
+		return changed;
+	}
+
+	bool Optimizer::removeJumpsToNext()
+	{
+		bool changed = false;
+
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			auto& ins = m_code[i];
+			if (m_removed[i] || !CFG::isJump(ins.daii.ocx.opCode) || !CFG::isDirectTarget(ins.daii, 0))
+				continue;
+
+			// Conditional jumps only read their operands, dropping them is fine as well.
+			if (nextLive(indexOf(ins.daii.args[0].value.cell.as_ADDR)) != nextLive(i + 1))
+				continue;
+
+			remove(i, "jumps to the next instruction removed");
+			changed = true;
+		}
+
+		return changed;
+	}
+
+	bool Optimizer::removeNoOps()
+	{
+		bool changed = false;
+
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			if (m_removed[i])
+				continue;
+
+			auto& ocx = m_code[i].daii.ocx;
+			auto& args = m_code[i].daii.args;
+			switch (ocx.opCode)
+			{
+			case BC_OC_MOVE:
+				// mov : X : @X
+				if (args[1].derefCount == args[0].derefCount + 1 && args[1].value.cell.as_ADDR == args[0].value.cell.as_ADDR)
+				{
+					remove(i, "self moves removed");
+					changed = true;
+				}
+				break;
+			case BC_OC_ADD:
+			case BC_OC_SUBTRACT:
+			case BC_OC_MULTIPLY:
+			case BC_OC_DIVIDE:
+				if (isIdentityOperand(ocx.opCode, ocx.datatype, args[1]))
+				{
+					remove(i, "identity arithmetic removed");
+					changed = true;
+				}
+				break;
+			case BC_OC_PUSH_N_BYTES:
+			case BC_OC_POP_N_BYTES:
+				if (args[0].derefCount == 0 && args[0].value.cell.as_U_64 == 0)
+				{
+					remove(i, "zero sized pushes/pops removed");
+					changed = true;
+				}
+				break;
+			case BC_OC_PUSH_COPY:
+			{
+				// pushc : @X  followed by  popc : X
+				uint64_t j = nextLive(i + 1);
+				if (j >= m_code.size() || isTarget(j))
+					break;
+				auto& next = m_code[j].daii;
+				if (next.ocx.opCode != BC_OC_POP_COPY || next.ocx.datatype != ocx.datatype)
+					break;
+				auto& dest = next.args[0];
+				if (args[0].derefCount != dest.derefCount + 1 || args[0].value.cell.as_ADDR != dest.value.cell.as_ADDR)
+					break;
+				remove(i, "push/pop pairs removed");
+				remove(j, "");
+				changed = true;
+				break;
+			}
+			default:
+				break;
+			}
+		}
+
+		return changed;
+	}
+
+	bool Optimizer::removeTempSaves()
+	{
+		// Macros like 'arrRead' save '$td' on the stack and restore it afterwards ('pushc : @$td ... popc : $td').
+		// Both can go if the restored value is overwritten before anybody reads it.
+		// Programs taking the address of '$td' could read it through a pointer, they are left alone.
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			if (m_removed[i])
+				continue;
+			for (auto& arg : m_code[i].daii.args)
+			{
+				if (arg.argType != InsArgType::Address && arg.derefCount == 0 && refersTo(arg, RegTemporaryData))
+					return false;
+			}
+		}
+
+		std::vector<std::pair<uint64_t, uint64_t>> pairs;
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			auto& save = m_code[i].daii;
+			if (m_removed[i] || save.ocx.opCode != BC_OC_PUSH_COPY || save.args[0].derefCount != 1 || !refersTo(save.args[0], RegTemporaryData))
+				continue;
+
+			for (uint64_t j = nextLive(i + 1); j < m_code.size() && !isTarget(j); j = nextLive(j + 1))
+			{
+				auto& ins = m_code[j].daii;
+				auto oc = ins.ocx.opCode;
+				if (oc == BC_OC_POP_COPY)
+				{
+					if (ins.ocx.datatype == save.ocx.datatype && ins.args[0].derefCount == 0 && refersTo(ins.args[0], RegTemporaryData))
+						pairs.push_back({ i, j });
+					break;
+				}
+
+				// The saved value must stay on top of the stack untouched.
+				bool touchesStack = isStackOp(oc) || CFG::isControlFlow(ins) || oc == BC_OC_CALL_EXTERN;
+				for (auto& arg : ins.args)
+				{
+					if (refersTo(arg, RegStackPointer) || refersTo(arg, RegFramePointer) || (CFG::isAddressArg(arg) && arg.value.cell.as_ADDR.base == BC_MEM_BASE_DYNAMIC_STACK))
+						touchesStack = true;
+				}
+				if (touchesStack)
+					break;
+			}
+		}
+
+		// Back to front, removing a later pair removes the read of '$td' by its save.
+		bool changed = false;
+		for (auto it = pairs.rbegin(); it != pairs.rend(); ++it)
+		{
+			if (!tempDeadAfter(it->second))
+				continue;
+
+			remove(it->first, "temporary register saves removed");
+			remove(it->second, "");
+			changed = true;
+		}
+
+		return changed;
+	}
+
+	bool Optimizer::foldConstantBranches()
+	{
+		bool changed = false;
+
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			auto& daii = m_code[i].daii;
+			if (m_removed[i] || !CFG::isConditionalJump(daii.ocx.opCode))
+				continue;
+
+			// Operands known at assembly time (literals, '#alias'es, ...) decide the branch once and for all.
+			auto& left = daii.args[1];
+			auto& right = daii.args[2];
+			bool result = false;
+			if (left.derefCount > 0 || right.derefCount > 0 || !evaluateCondition(daii.ocx.opCode, daii.ocx.datatype, left.value.cell, right.value.cell, result))
+				continue;
+
+			++m_report.rewrites["constant branches folded"];
+			changed = true;
+
+			if (!result)
+			{
+				m_removed[i] = true;
+				continue;
+			}
+
+			BC_OpCodeEx ocx;
+			ocx.opCode = BC_OC_JUMP;
+			daii = encodeInstruction(m_exeInfo->codeEncoding, ocx, { daii.args[0] }).daii;
+		}
+
+		return changed;
+	}
+
+	bool Optimizer::removeUnreachableCode()
+	{
+		compact();
+
+		CFG cfg(m_code, m_codeSize);
+		auto reachable = cfg.reachableBlocks();
+
+		bool changed = false;
+		for (uint64_t b = 0; b < cfg.getBlocks().size(); ++b)
+		{
+			if (reachable[b])
+				continue;
+
+			auto& block = cfg.getBlocks()[b];
+			for (uint64_t i = block.begin; i < block.end; ++i)
+			{
+				m_unreachable.insert(m_code[i].offset);
+				remove(i, "unreachable instructions removed");
+			}
+			changed = true;
+		}
+
+		return changed;
+	}
+
+	void Optimizer::removeUnusedStatics()
+	{
+		// Static data is addressed through the symbol of a '#static' directive or the address of a string literal.
+		// Every such address starts an object reaching up to the next one, objects no instruction refers to get dropped.
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			if (m_removed[i])
+				continue;
+			for (auto& arg : m_code[i].daii.args)
+			{
+				if (mayHoldAddress(arg, BC_MEM_BASE_STATIC_STACK))
+					return;
+				if (CFG::isAddressArg(arg) && arg.value.cell.as_ADDR.base == BC_MEM_BASE_STATIC_STACK && arg.value.cell.as_ADDR.addr < 0)
+					return;
+			}
+		}
+
+		auto& staticStack = m_exeInfo->staticStack;
+		std::set<uint64_t> objects;
+		std::set<uint64_t> used;
+		objects.insert(0);
+		objects.insert(staticStack.size());
+
+		for (auto& symbol : m_exeInfo->symbols)
+		{
+			if (symbol.usage == SymbolUsage::Address && symbol.value.as_ADDR.base == BC_MEM_BASE_STATIC_STACK && symbol.value.as_ADDR.addr >= 0)
+				objects.insert(std::min<uint64_t>(symbol.value.as_ADDR.addr, staticStack.size()));
+		}
+
+		std::vector<uint64_t> references;
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			if (m_removed[i])
+				continue;
+			for (auto& arg : m_code[i].daii.args)
+			{
+				if (CFG::isAddressArg(arg) && arg.value.cell.as_ADDR.base == BC_MEM_BASE_STATIC_STACK)
+				{
+					uint64_t addr = std::min<uint64_t>(arg.value.cell.as_ADDR.addr, staticStack.size());
+					objects.insert(addr);
+					references.push_back(addr);
+				}
+			}
+		}
+
+		auto objectOf = [&](uint64_t addr) { return *--objects.upper_bound(std::min<uint64_t>(addr, staticStack.size())); };
+		for (uint64_t addr : references)
+			used.insert(objectOf(addr));
+
+		Memory newStaticStack;
+		std::map<uint64_t, uint64_t> newStarts; // Old start of a kept object -> new start
+		uint64_t nRemoved = 0;
+		for (auto it = objects.begin(); it != objects.end(); ++it)
+		{
+			uint64_t begin = *it;
+			if (begin == staticStack.size())
+			{
+				newStarts.insert({ begin, newStaticStack.size() });
+				break;
+			}
+
+			uint64_t end = *std::next(it);
+			if (used.find(begin) == used.end())
+			{
+				nRemoved += end - begin;
+				continue;
+			}
+
+			newStarts.insert({ begin, newStaticStack.size() });
+			newStaticStack.push((const char*)staticStack.getBaseAddress() + begin, end - begin);
+		}
+
+		if (nRemoved == 0)
+			return;
+
+		auto relocate = [&](BC_MemAddress addr) {
+			uint64_t begin = objectOf(addr.addr);
+			return BC_MemAddress(BC_MEM_BASE_STATIC_STACK, newStarts.at(begin) + (addr.addr - begin));
+		};
+
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			if (m_removed[i])
+				continue;
+			for (uint64_t j = 0; j < m_code[i].daii.args.size(); ++j)
+			{
+				auto& arg = m_code[i].daii.args[j];
+				if (CFG::isAddressArg(arg) && arg.value.cell.as_ADDR.base == BC_MEM_BASE_STATIC_STACK)
+					setArgValue(m_code[i], j, relocate(arg.value.cell.as_ADDR));
+			}
+		}
+
+		std::set<Symbol> symbols;
+		for (auto symbol : m_exeInfo->symbols)
+		{
+			if (symbol.usage == SymbolUsage::Address && symbol.value.as_ADDR.base == BC_MEM_BASE_STATIC_STACK && symbol.value.as_ADDR.addr >= 0)
+			{
+				if (newStarts.find(objectOf(symbol.value.as_ADDR.addr)) == newStarts.end())
+					continue;
+				symbol.value.as_ADDR = relocate(symbol.value.as_ADDR);
+			}
+			symbols.insert(symbol);
+		}
+		m_exeInfo->symbols = std::move(symbols);
+
+		newStaticStack.shrinkToFit();
+		staticStack = std::move(newStaticStack);
+		m_report.staticSizeAfter = staticStack.size();
+		m_report.rewrites["unused static bytes removed"] += nRemoved;
+	}
+
+	bool Optimizer::inlineCalls()
+	{
+		compact();
+
+		CFG cfg(m_code, m_codeSize);
+		auto depths = cfg.stackDepths(m_code);
+
+		std::map<uint64_t, InlineCandidate> candidates;
+		std::vector<CodeInstruction> code;
+		std::vector<uint64_t> newIndex(m_code.size() + 1);
+		std::vector<Fixup> fixups;
+		bool changed = false;
+
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			newIndex[i] = code.size();
+
+			auto& call = m_code[i].daii;
+			if (call.ocx.opCode != BC_OC_CALL || !CFG::isDirectTarget(call, 0) || depths[i] == CFG::UnknownStackDepth || depths[i] < 0)
+			{
+				appendCopy(code, fixups, m_code[i]);
+				continue;
+			}
+
+			uint64_t entry = indexOf(call.args[0].value.cell.as_ADDR);
+			auto itCandidate = candidates.find(entry);
+			if (itCandidate == candidates.end())
+				itCandidate = candidates.insert({ entry, analyzeInlineCandidate(entry) }).first;
+			auto& candidate = itCandidate->second;
+
+			int64_t depth = depths[i];
+			int64_t retSize = BC_DatatypeSize(call.ocx.datatype);
+			bool inlinable = candidate.inlinable;
+
+			// Below the frame pointer the callee may only touch its return value, not the return address and old frame pointer.
+			if (candidate.maxFrameOffset != INT64_MIN && (candidate.minFrameOffset < -(16 + retSize) || candidate.maxFrameOffset >= -16))
+				inlinable = false;
+
+			// The arguments get pushed without the return address and old frame pointer in front of them.
+			for (uint64_t j = 1; j < call.args.size(); ++j)
+				inlinable &= isFrameIndependentArg(call.args[j], depth);
+
+			if (!inlinable)
+			{
+				appendCopy(code, fixups, m_code[i]);
+				continue;
+			}
+
+			std::string callee = describeCodeAddr(m_code[entry].offset);
+			m_report.inlinedCalls.push_back("'" + callee + "' into " + describeCodeAddr(m_code[i].offset));
+			changed = true;
+
+			// The return value slot and the arguments take the place of the callee's frame.
+			if (retSize > 0)
+				code.push_back(encodeStackResize(m_exeInfo->codeEncoding, BC_OC_PUSH_N_BYTES, retSize));
+			for (uint64_t j = 1; j < call.args.size(); ++j)
+				code.push_back(encodeArgCopy(m_exeInfo->codeEncoding, BC_OC_PUSH_COPY, {}, call.args[j]));
+
+			uint64_t bodyStart = code.size();
+			int64_t argBase = depth + retSize;
+			for (uint64_t k = entry; k < candidate.ret; ++k)
+			{
+				auto ins = m_code[k];
+				for (uint64_t j = 0; j < ins.daii.args.size(); ++j)
+				{
+					auto& arg = ins.daii.args[j];
+					if (CFG::isCodeAddressArg(arg))
+					{
+						// Returning continues behind the inlined body.
+						fixups.push_back({ code.size(), j, bodyStart + (indexOf(arg.value.cell.as_ADDR) - entry), true });
+						continue;
+					}
+					if (!CFG::isAddressArg(arg) || arg.value.cell.as_ADDR.base != BC_MEM_BASE_DYNAMIC_FRAME)
+						continue;
+
+					int64_t offset = arg.value.cell.as_ADDR.addr;
+					offset = offset >= 0 ? argBase + offset : depth + (offset + 16 + retSize);
+					setArgValue(ins, j, BC_MemAddress(BC_MEM_BASE_DYNAMIC_FRAME, offset));
+				}
+				code.push_back(std::move(ins));
+			}
+
+			uint64_t frameSize = CFG::callArgSize(call) + candidate.localSize;
+			if (frameSize > 0)
+				code.push_back(encodeStackResize(m_exeInfo->codeEncoding, BC_OC_POP_N_BYTES, frameSize));
+		}
+		newIndex[m_code.size()] = code.size();
+
+		if (changed)
+			relayout(std::move(code), newIndex, fixups);
+		return changed;
+	}
+
+	Optimizer::InlineCandidate Optimizer::analyzeInlineCandidate(uint64_t entry) const
+	{
+		// Only leaf functions with a single 'return' and a fixed frame can be moved into the caller's frame.
+		InlineCandidate candidate;
+
+		uint64_t ret = entry;
+		while (ret < m_code.size() && m_code[ret].daii.ocx.opCode != BC_OC_RETURN)
+			++ret;
+		if (ret == m_code.size() || ret - entry > m_inlineLimit)
+			return candidate;
+		candidate.ret = ret;
+
+		uint64_t bodyBegin = entry;
+		auto& prologue = m_code[entry].daii;
+		if (entry < ret && prologue.ocx.opCode == BC_OC_PUSH_N_BYTES && prologue.args[0].derefCount == 0)
+		{
+			candidate.localSize = prologue.args[0].value.cell.as_U_64;
+			++bodyBegin;
+		}
+
+		for (uint64_t i = bodyBegin; i < ret; ++i)
+		{
+			auto& daii = m_code[i].daii;
+			auto oc = daii.ocx.opCode;
+			if (isStackOp(oc) || oc == BC_OC_CALL)
+				return candidate;
+			if (CFG::isControlFlow(daii) && !CFG::isJump(oc) && oc != BC_OC_EXIT)
+				return candidate;
+
+			for (uint64_t j = 0; j < daii.args.size(); ++j)
+			{
+				auto& arg = daii.args[j];
+				if (mayHoldAddress(arg, BC_MEM_BASE_DYNAMIC_FRAME) || mayHoldAddress(arg, BC_MEM_BASE_DYNAMIC_STACK))
+					return candidate;
+				if (!CFG::isAddressArg(arg))
+					continue;
+
+				auto addr = arg.value.cell.as_ADDR;
+				if (addr.base == BC_MEM_BASE_CODE_MEMORY)
+				{
+					uint64_t target = indexOf(addr);
+					if (!CFG::isDirectTarget(daii, j) || target < bodyBegin || target > ret)
+						return candidate;
+					continue;
+				}
+
+				if (addr == RegStackPointer || addr == RegFramePointer || addr.base == BC_MEM_BASE_DYNAMIC_STACK)
+					return candidate;
+				if (addr.base != BC_MEM_BASE_DYNAMIC_FRAME)
+					continue;
+				// Frame addresses are relative to the frame pointer, an address taken in the callee would point into the caller's frame.
+				if (arg.argType != InsArgType::Address && arg.derefCount == 0)
+					return candidate;
+				if (addr.addr < 0)
+				{
+					candidate.minFrameOffset = std::min(candidate.minFrameOffset, addr.addr);
+					candidate.maxFrameOffset = std::max(candidate.maxFrameOffset, addr.addr);
+				}
+			}
+		}
+
+		candidate.inlinable = true;
+		return candidate;
+	}
+
+	bool Optimizer::eliminateTailCalls()
+	{
+		compact();
+
+		CFG cfg(m_code, m_codeSize);
+		auto depths = cfg.stackDepths(m_code);
+
+		std::vector<CodeInstruction> code;
+		std::vector<uint64_t> newIndex(m_code.size() + 1);
+		std::vector<Fixup> fixups;
+		bool changed = false;
+
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			newIndex[i] = code.size();
+			if (!isTailCall(i, depths[i]))
+			{
+				appendCopy(code, fixups, m_code[i]);
+				continue;
+			}
+
+			// The callee takes over the current frame: Its arguments replace the current ones,
+			// the stack is cut back behind them and the callee returns directly to the current caller.
+			// All arguments are read before the first one is overwritten.
+			auto& call = m_code[i].daii;
+			uint64_t nArgs = call.args.size() - 1;
+			if (nArgs == 1)
+			{
+				code.push_back(encodeArgCopy(m_exeInfo->codeEncoding, BC_OC_MOVE, { frameAddressArg(0) }, call.args[1]));
+			}
+			else
+			{
+				std::vector<int64_t> argOffsets;
+				int64_t argOffset = 0;
+				for (uint64_t j = 1; j <= nArgs; ++j)
+				{
+					code.push_back(encodeArgCopy(m_exeInfo->codeEncoding, BC_OC_PUSH_COPY, {}, call.args[j]));
+					argOffsets.push_back(argOffset);
+					argOffset += BC_DatatypeSize(call.args[j].value.datatype);
+				}
+				for (uint64_t j = nArgs; j > 0; --j)
+				{
+					BC_OpCodeEx ocx;
+					ocx.opCode = BC_OC_POP_COPY;
+					ocx.datatype = call.args[j].value.datatype;
+					code.push_back(encodeInstruction(m_exeInfo->codeEncoding, ocx, { frameAddressArg(argOffsets[j - 1]) }));
+				}
+			}
+
+			uint64_t excess = depths[i] - CFG::callArgSize(call);
+			if (excess > 0)
+				code.push_back(encodeStackResize(m_exeInfo->codeEncoding, BC_OC_POP_N_BYTES, excess));
+
+			BC_OpCodeEx ocx;
+			ocx.opCode = BC_OC_JUMP;
+			fixups.push_back({ code.size(), 0, indexOf(call.args[0].value.cell.as_ADDR), false });
+			code.push_back(encodeInstruction(m_exeInfo->codeEncoding, ocx, { call.args[0] }));
+
+			++m_report.rewrites["tail calls turned into jumps"];
+			changed = true;
+		}
+		newIndex[m_code.size()] = code.size();
+
+		// The 'popc'/'return' behind the former calls become unreachable unless something else jumps there.
+		if (changed)
+			relayout(std::move(code), newIndex, fixups);
+		return changed;
+	}
+
+	bool Optimizer::isTailCall(uint64_t index, int64_t depth) const
+	{
+		auto& call = m_code[index].daii;
+		if (call.ocx.opCode != BC_OC_CALL || !CFG::isDirectTarget(call, 0))
+			return false;
+		if (depth == CFG::UnknownStackDepth || depth < (int64_t)CFG::callArgSize(call))
+			return false;
+
+		// call.dt : F : ~-(16 + sizeof(dt)) : ...  (the return value alias of the current function)
+		uint64_t next = index + 1;
+		if (call.ocx.datatype != BC_DT_NONE)
+		{
+			if (next >= m_code.size())
+				return false;
+			auto& pop = m_code[next].daii;
+			BC_MemAddress retAddr(BC_MEM_BASE_DYNAMIC_FRAME, -(16 + (int64_t)BC_DatatypeSize(call.ocx.datatype)));
+			if (pop.ocx.opCode != BC_OC_POP_COPY || pop.ocx.datatype != call.ocx.datatype ||
+				pop.args[0].derefCount != 0 || pop.args[0].value.cell.as_ADDR != retAddr)
+				return false;
+			++next;
+		}
+		if (next >= m_code.size() || m_code[next].daii.ocx.opCode != BC_OC_RETURN)
+			return false;
+
+		for (uint64_t j = 1; j < call.args.size(); ++j)
+		{
+			if (!isFrameIndependentArg(call.args[j], depth))
+				return false;
+		}
+
+		return true;
+	}
+
+	void Optimizer::relayout(std::vector<CodeInstruction> code, const std::vector<uint64_t>& newIndex, const std::vector<Fixup>& fixups)
+	{
+		uint64_t codeSize = 0;
+		for (auto& ins : code)
+		{
+			ins.offset = codeSize;
+			codeSize += paddedSize(m_exeInfo->codeEncoding, ins);
+		}
+
+		auto newCodeAddr = [&](uint64_t index) {
+			return BC_MemAddress(BC_MEM_BASE_CODE_MEMORY, index < code.size() ? code[index].offset : codeSize);
+		};
+		for (auto& fixup : fixups)
+			setArgValue(code[fixup.insIndex], fixup.argIndex, newCodeAddr(fixup.isNewIndex ? fixup.target : newIndex[fixup.target]));
+		relocateCodeSymbols([&](BC_MemAddress addr) { return newCodeAddr(newIndex[indexOf(addr)]); });
+
+		m_code = std::move(code);
+		m_removed.assign(m_code.size(), false);
+		m_codeSize = codeSize;
+	}
+
+	void Optimizer::appendCopy(std::vector<CodeInstruction>& code, std::vector<Fixup>& fixups, const CodeInstruction& ins) const
+	{
+		for (uint64_t j = 0; j < ins.daii.args.size(); ++j)
+		{
+			if (CFG::isCodeAddressArg(ins.daii.args[j]))
+				fixups.push_back({ code.size(), j, indexOf(ins.daii.args[j].value.cell.as_ADDR), false });
+		}
+		code.push_back(ins);
+	}
+
+	void Optimizer::compact()
+	{
+		// Point all code addresses at remaining instructions, the removed ones can be dropped afterwards.
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			if (m_removed[i])
+				continue;
+			for (uint64_t j = 0; j < m_code[i].daii.args.size(); ++j)
+			{
+				auto& arg = m_code[i].daii.args[j];
+				if (CFG::isCodeAddressArg(arg))
+					setArgValue(m_code[i], j, codeAddrOf(nextLive(indexOf(arg.value.cell.as_ADDR))));
+			}
+		}
+		relocateCodeSymbols([&](BC_MemAddress addr) { return codeAddrOf(nextLive(indexOf(addr))); });
+
+		std::vector<CodeInstruction> code;
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			if (!m_removed[i])
+				code.push_back(std::move(m_code[i]));
+		}
+		m_code = std::move(code);
+		m_removed.assign(m_code.size(), false);
+
+		// Their symbols are gone, the offsets may be reused by a new layout.
+		m_unreachable.clear();
+	}
+
+	void Optimizer::rebuild()
+	{
+		std::vector<uint64_t> newOffsets(m_code.size() + 1);
+		uint64_t offset = 0;
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			newOffsets[i] = offset;
+			if (!m_removed[i])
+				offset += paddedSize(m_exeInfo->codeEncoding, m_code[i]);
+		}
+		newOffsets[m_code.size()] = offset;
+
+		// Addresses of removed instructions map to the next remaining one.
+		auto relocate = [&](BC_MemAddress addr) {
+			return BC_MemAddress(BC_MEM_BASE_CODE_MEMORY, newOffsets[nextLive(indexOf(addr))]);
+		};
+
+		Memory codeMemory;
+		m_report.nInsAfter = 0;
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			if (m_removed[i])
+				continue;
+
+			auto& ins = m_code[i];
+			for (uint64_t j = 0; j < ins.daii.args.size(); ++j)
+			{
+				if (CFG::isCodeAddressArg(ins.daii.args[j]))
+					setArgValue(ins, j, relocate(ins.daii.args[j].value.cell.as_ADDR));
+			}
+
+			codeMemory.push(ins.daii.rawData.data(), ins.daii.rawData.size());
+			codeMemory.resize(codeMemory.size() + paddedSize(m_exeInfo->codeEncoding, ins) - ins.daii.rawData.size());
+			++m_report.nInsAfter;
+		}
+		relocateCodeSymbols(relocate);
+
+		codeMemory.shrinkToFit();
+		m_exeInfo->codeMemory = std::move(codeMemory);
+		m_report.codeSizeAfter = m_exeInfo->codeMemory.size();
+
+		m_report.rewrites.erase("");
+	}
+
+	uint64_t Optimizer::indexOf(BC_MemAddress codeAddr) const
+	{
+		return CFG::indexOf(m_code, m_codeSize, codeAddr);
+	}
+
+	uint64_t Optimizer::nextLive(uint64_t index) const
+	{
+		while (index < m_code.size() && m_removed[index])
+			++index;
+		return index;
+	}
+
+	bool Optimizer::isTarget(uint64_t index) const
+	{
+		return m_targets.find(index) != m_targets.end();
+	}
+
+	BC_MemAddress Optimizer::codeAddrOf(uint64_t index) const
+	{
+		return BC_MemAddress(BC_MEM_BASE_CODE_MEMORY, index < m_code.size() ? m_code[index].offset : m_codeSize);
+	}
+
+	void Optimizer::setArgValue(CodeInstruction& ins, uint64_t argIndex, BC_MemAddress addr)
+	{
+		auto& arg = ins.daii.args[argIndex];
+		arg.value.cell.as_ADDR = addr;
+		if (m_exeInfo->codeEncoding != BC_CodeEncoding::Compact)
+			memcpy(ins.daii.rawData.data() + arg.offset, &addr, sizeof(addr));
+		else if (!BC_PatchCompactAddress(ins.daii.rawData.data() + arg.offset, addr))
+			encodeOperands(m_exeInfo->codeEncoding, ins.daii); // Only frame offsets grow, code addresses always keep their size.
+	}
+
+	void Optimizer::remove(uint64_t index, const std::string& rewrite)
+	{
+		m_removed[index] = true;
+		++m_report.rewrites[rewrite];
+	}
+
+	void Optimizer::relocateCodeSymbols(const std::function<BC_MemAddress(BC_MemAddress)>& relocate)
+	{
+		// Symbols of unreachable code are dropped with it.
+		std::set<Symbol> symbols;
+		for (auto symbol : m_exeInfo->symbols)
+		{
+			if (symbol.usage == SymbolUsage::Address && symbol.value.as_ADDR.base == BC_MEM_BASE_CODE_MEMORY)
+			{
+				if (m_unreachable.find(symbol.value.as_ADDR.addr) != m_unreachable.end())
+					continue;
+				symbol.value.as_ADDR = relocate(symbol.value.as_ADDR);
+			}
+			symbols.insert(symbol);
+		}
+		m_exeInfo->symbols = std::move(symbols);
+	}
+
+	std::string Optimizer::describeCodeAddr(uint64_t offset) const
+	{
+		// The closest label/function in front of the address, the shortest name wins among symbols at the same address.
+		const Symbol* closest = nullptr;
+		for (auto& symbol : m_exeInfo->symbols)
+		{
+			if (symbol.usage != SymbolUsage::Address || symbol.value.as_ADDR.base != BC_MEM_BASE_CODE_MEMORY || (uint64_t)symbol.value.as_ADDR.addr > offset)
+				continue;
+			if (symbol.name.find(">>SCOPE_END") != std::string::npos)
+				continue;
+			if (!closest || symbol.value.as_ADDR.addr > closest->value.as_ADDR.addr ||
+				(symbol.value.as_ADDR.addr == closest->value.as_ADDR.addr && symbol.name.size() < closest->name.size()))
+				closest = &symbol;
+		}
+
+		auto plainAddr = BC_MemAddressToString(BC_MemAddress(BC_MEM_BASE_CODE_MEMORY, offset));
+		if (!closest)
+			return plainAddr;
+
+		// Top level code behind a function isn't part of it, neither the symbol nor any scope around it may have ended in front of the address.
+		std::string scope = closest->name;
+		while (true)
+		{
+			auto itEnd = m_exeInfo->symbols.find(Symbol(scope + ">>SCOPE_END"));
+			if (itEnd != m_exeInfo->symbols.end() && (uint64_t)itEnd->value.as_ADDR.addr <= offset)
+				return plainAddr;
+			auto sep = scope.rfind(">>");
+			if (sep == std::string::npos || sep == 0)
+				break;
+			scope.resize(sep);
+		}
+
+		if ((uint64_t)closest->value.as_ADDR.addr == offset)
+			return closest->name;
+		return closest->name + "+" + std::to_string(offset - closest->value.as_ADDR.addr);
+	}
+
+	Optimizer::TempAccess Optimizer::tempAccess(const CodeInstruction& ins) const
+	{
+		auto oc = ins.daii.ocx.opCode;
+		auto access = TempAccess::None;
+
+		for (uint64_t i = 0; i < ins.daii.args.size(); ++i)
+		{
+			auto& arg = ins.daii.args[i];
+			if (!refersTo(arg, RegTemporaryData))
+				continue;
+
+			bool overwritesAll = i == 0 && arg.argType == InsArgType::Address && arg.derefCount == 0 && (
+				((oc == BC_OC_MOVE || oc == BC_OC_POP_COPY) && BC_DatatypeSize(ins.daii.ocx.datatype) == sizeof(BC_MemCell)) ||
+				oc == BC_OC_ALLOCATE
+				);
+			if (!overwritesAll)
+				return TempAccess::Read;
+			access = TempAccess::Write;
+		}
+
+		return access;
+	}
+
+	bool Optimizer::tempDeadAfter(uint64_t index) const
+	{
+		for (uint64_t i = nextLive(index + 1); i < m_code.size(); i = nextLive(i + 1))
+		{
+			if (isTarget(i))
+				return false;
+
+			auto& ins = m_code[i];
+			switch (tempAccess(ins))
+			{
+			case TempAccess::Read: return false;
+			case TempAccess::Write: return true;
+			case TempAccess::None: break;
+			}
+
+			if (ins.daii.ocx.opCode == BC_OC_EXIT)
+				return true;
+			if (CFG::isControlFlow(ins.daii) || ins.daii.ocx.opCode == BC_OC_CALL_EXTERN)
+				return false;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,185 @@
+#include "Verifier.h"
+
+#include <cstring>
+
+#include "Disassembler.h"
+
+namespace MarC
+{
+	Verifier::Verifier(ExecutableInfoRef exeInfo)
+		: m_exeInfo(exeInfo)
+	{}
+
+	bool Verifier::verify()
+	{
+		resetError();
+		m_code.clear();
+
+		try
+		{
+			decode();
+			for (auto& ins : m_code)
+				verifyInstruction(ins);
+			verifyStackDepths();
+		}
+		catch (const VerifierError& err)
+		{
+			m_lastErr = err;
+		}
+
+		return !m_lastErr;
+	}
+
+	void Verifier::decode()
+	{
+		auto encoding = m_exeInfo->codeEncoding;
+		if (encoding != BC_CodeEncoding::Packed && encoding != BC_CodeEncoding::Aligned && encoding != BC_CodeEncoding::Compact)
+			throw VerifierError(VerifErrCode::InvalidEncoding, std::to_string((uint64_t)encoding));
+
+		auto& codeMem = m_exeInfo->codeMemory;
+		auto code = Disassembler::paddedCode(codeMem);
+
+		uint64_t offset = 0;
+		while (offset < codeMem.size())
+		{
+			DisAsmInsInfo daii;
+			switch (Disassembler::disassembleChecked(code, codeMem.size(), offset, encoding, daii))
+			{
+			case DisAsmCheck::Ok:
+				break;
+			case DisAsmCheck::InvalidOpCode:
+				throw VerifierError(VerifErrCode::InvalidOpCode, "code offset " + std::to_string(offset));
+			case DisAsmCheck::InvalidDatatype:
+				throw VerifierError(VerifErrCode::InvalidDatatype, "code offset " + std::to_string(offset));
+			case DisAsmCheck::Truncated:
+				throw VerifierError(VerifErrCode::TruncatedInstruction, "code offset " + std::to_string(offset));
+			}
+
+			uint64_t size = daii.rawData.size();
+			m_code.push_back({ offset, std::move(daii) });
+			offset = BC_AlignOffset(offset + size, BC_InstructionAlignment(encoding));
+		}
+	}
+
+	void Verifier::verifyInstruction(const CodeInstruction& ins) const
+	{
+		auto& ocx = ins.daii.ocx;
+		auto& layout = InstructionLayoutFromOpCode(ocx.opCode);
+		if (ocx.datatype == BC_DT_UNKNOWN || (layout.insDt == InsDt::Required && ocx.datatype == BC_DT_NONE))
+			throw VerifierError(VerifErrCode::InvalidDatatype, location(ins));
+
+		for (uint64_t i = 0; i < ins.daii.args.size(); ++i)
+			verifyArgument(ins, i);
+	}
+
+	void Verifier::verifyArgument(const CodeInstruction& ins, uint64_t argIndex) const
+	{
+		auto& daii = ins.daii;
+		auto& arg = daii.args[argIndex];
+
+		if (arg.argType == InsArgType::Datatype)
+		{
+			// The interpreter reads the datatype itself, it can't be dereferenced.
+			if (arg.derefCount > 0)
+				throw VerifierError(VerifErrCode::InvalidDerefCount, location(ins));
+			if (arg.value.cell.as_Datatype < BC_DT_I_8 || arg.value.cell.as_Datatype > BC_DT_ADDR)
+				throw VerifierError(VerifErrCode::InvalidDatatype, location(ins));
+			return;
+		}
+
+		if (!ControlFlowGraph::isAddressArg(arg))
+			return;
+
+		if (m_exeInfo->codeEncoding == BC_CodeEncoding::Compact && ((uint8_t)daii.rawData[arg.offset] >> 4) > BC_CAW_64)
+			throw VerifierError(VerifErrCode::InvalidAddress, location(ins));
+
+		auto addr = arg.value.cell.as_ADDR;
+		if (arg.derefCount > 0)
+			verifyAccess(ins, addr, false);
+		else if (arg.argType == InsArgType::Address && accessesAddressArg(daii.ocx.opCode, argIndex))
+			verifyAccess(ins, addr, true);
+		else if (daii.ocx.opCode == BC_OC_CALL_EXTERN && argIndex == 0)
+			verifyExternalName(ins, addr);
+		else if (addr.base == BC_MEM_BASE_CODE_MEMORY && ControlFlowGraph::indexOf(m_code, m_exeInfo->codeMemory.size(), addr) == (uint64_t)-1)
+			throw VerifierError(VerifErrCode::InvalidCodeAddress, location(ins)); // Jump/call targets and function addresses used as values
+	}
+
+	void Verifier::verifyAccess(const CodeInstruction& ins, BC_MemAddress addr, bool isWrite) const
+	{
+		bool valid = false;
+		switch (addr.base)
+		{
+		case BC_MEM_BASE_STATIC_STACK:
+			valid = addr.addr >= 0 && (uint64_t)addr.addr < m_exeInfo->staticStack.size();
+			break;
+		case BC_MEM_BASE_CODE_MEMORY:
+			// Changing the code would invalidate the verification.
+			if (isWrite)
+				throw VerifierError(VerifErrCode::CodeWrite, location(ins));
+			valid = addr.addr >= 0 && (uint64_t)addr.addr < m_exeInfo->codeMemory.size();
+			break;
+		case BC_MEM_BASE_REGISTER:
+			valid = addr.addr >= 0 && (uint64_t)addr.addr < _BC_MEM_REG_NUM * sizeof(BC_MemCell);
+			break;
+		case BC_MEM_BASE_DYNAMIC_STACK:
+		case BC_MEM_BASE_DYNAMIC_FRAME:
+		case BC_MEM_BASE_EXTERN:
+			// Only known at runtime.
+			valid = true;
+			break;
+		}
+
+		if (!valid)
+			throw VerifierError(VerifErrCode::InvalidAddress, location(ins));
+	}
+
+	void Verifier::verifyExternalName(const CodeInstruction& ins, BC_MemAddress addr) const
+	{
+		auto& staticStack = m_exeInfo->staticStack;
+		if (addr.base != BC_MEM_BASE_STATIC_STACK || addr.addr < 0 || (uint64_t)addr.addr >= staticStack.size() ||
+			!memchr((const char*)staticStack.getBaseAddress() + addr.addr, '\0', staticStack.size() - addr.addr))
+			throw VerifierError(VerifErrCode::InvalidExternalName, location(ins));
+	}
+
+	void Verifier::verifyStackDepths() const
+	{
+		ControlFlowGraph cfg(m_code, m_exeInfo->codeMemory.size());
+		auto depths = cfg.stackDepths(m_code);
+		for (uint64_t i = 0; i < m_code.size(); ++i)
+		{
+			int64_t depth = ControlFlowGraph::applyStackEffect(m_code[i].daii, depths[i]);
+			if (depth != ControlFlowGraph::UnknownStackDepth && depth < 0)
+				throw VerifierError(VerifErrCode::StackUnderflow, location(m_code[i]));
+		}
+	}
+
+	bool Verifier::accessesAddressArg(BC_OpCode oc, uint64_t argIndex)
+	{
+		switch (oc)
+		{
+		case BC_OC_CALL:
+		case BC_OC_CALL_EXTERN:
+		case BC_OC_FREE:
+			return argIndex != 0;
+		case BC_OC_SET_ADDRESS_BASE:
+			return argIndex != 1; // Only the base of the source gets used.
+		default:
+			return !ControlFlowGraph::isJump(oc);
+		}
+	}
+
+	std::string Verifier::location(const CodeInstruction& ins) const
+	{
+		return "code offset " + std::to_string(ins.offset) + " ('" + DisAsmInsInfoToString(ins.daii, m_exeInfo->symbols) + "')";
+	}
+
+	const VerifierError& Verifier::lastError() const
+	{
+		return m_lastErr;
+	}
+
+	void Verifier::resetError()
+	{
+		m_lastErr = VerifierError();
+	}
+}
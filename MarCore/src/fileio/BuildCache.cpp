@@ -0,0 +1,258 @@
+#include "fileio/BuildCache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <filesystem>
+
+#include "AsmScanning.h"
+#include "fileio/ModuleLocator.h"
+#include "fileio/CodeFileReader.h"
+#include "errors/MarCoreError.h"
+
+namespace MarC
+{
+	struct CacheEntryHeader
+	{
+		char magic[8] = { 'M', 'A', 'R', 'C', 'C', 'A', 'C', 'H' };
+		uint64_t version = BuildCache::FormatVersion;
+	};
+	MARC_SERIALIZER_ENABLE_FIXED(CacheEntryHeader);
+
+	// Collects the names of all modules requested with '#reqmod : "<name>"'.
+	// The scan is purely textual and may report more modules than the ModuleLoader does (e.g. inside comments),
+	// which only makes the key more specific.
+	static void scanRequiredModules(const std::string& code, std::set<std::string>& modNames)
+	{
+		static const std::string Directive = "reqmod";
+
+		for (auto pos = code.find(Directive); pos != std::string::npos; pos = code.find(Directive, pos + Directive.size()))
+		{
+			uint64_t i = AsmScan::skipBlanks(code, pos + Directive.size());
+			if (code[i] != ':')
+				continue;
+			i = AsmScan::skipBlanks(code, i + 1);
+			if (code[i] != '"')
+				continue;
+			auto end = code.find('"', i + 1);
+			if (end == std::string::npos)
+				continue;
+			modNames.insert(code.substr(i + 1, end - i - 1));
+		}
+	}
+
+	static void appendKeyField(std::string& material, const std::string& field)
+	{
+		uint64_t size = field.size();
+		material.append((const char*)&size, sizeof(size));
+		material.append(field);
+	}
+
+	static uint64_t hashFNV1a(const std::string& data)
+	{
+		uint64_t hash = 0xcbf29ce484222325;
+		for (unsigned char c : data)
+		{
+			hash ^= c;
+			hash *= 0x100000001b3;
+		}
+		return hash;
+	}
+
+	BuildCache::BuildCache(const std::string& cacheDir, const std::string& toolID)
+		: m_cacheDir(cacheDir), m_toolID(toolID)
+	{}
+
+	BuildCache::Key BuildCache::makeKey(const std::string& kind, const std::string& modPath, const std::set<std::string>& modDirs) const
+	{
+		Key key;
+
+		appendKeyField(key.material, kind);
+		appendKeyField(key.material, std::to_string(FormatVersion));
+		appendKeyField(key.material, m_toolID);
+
+		std::string code = readCodeFile(modPath);
+		appendKeyField(key.material, modNameFromPath(modPath));
+		appendKeyField(key.material, code);
+
+		std::set<std::string> pending;
+		scanRequiredModules(code, pending);
+
+		// Module name -> contents of all candidates, the ModuleLoader refuses ambiguous names but the key has to reflect them anyway.
+		std::map<std::string, std::vector<std::string>> modules;
+		while (!pending.empty())
+		{
+			auto found = locateModules(modDirs, pending);
+			pending.clear();
+
+			for (auto& [modName, paths] : found)
+			{
+				auto& contents = modules[modName];
+				for (auto& path : paths)
+				{
+					contents.push_back(readCodeFile(path));
+					std::set<std::string> required;
+					scanRequiredModules(contents.back(), required);
+					for (auto& reqName : required)
+					{
+						if (modules.find(reqName) == modules.end())
+							pending.insert(reqName);
+					}
+				}
+			}
+		}
+
+		for (auto& [modName, contents] : modules)
+		{
+			appendKeyField(key.material, modName);
+			appendKeyField(key.material, std::to_string(contents.size()));
+			for (auto& content : contents)
+				appendKeyField(key.material, content);
+		}
+
+		key.hash = hashFNV1a(key.material);
+
+		return key;
+	}
+
+	ExecutableInfoRef BuildCache::loadExecutable(const Key& key) const
+	{
+		std::ifstream iStream;
+		if (!openEntry(key, iStream))
+			return nullptr;
+
+		auto exeInfo = ExecutableInfo::create();
+		deserialize(*exeInfo, iStream);
+
+		if (!iStream.good())
+			return nullptr;
+
+		return exeInfo;
+	}
+
+	void BuildCache::storeExecutable(const Key& key, const ExecutableInfo& exeInfo) const
+	{
+		writeEntry(key, [&](std::ostream& oStream) {
+			serialize(exeInfo, oStream);
+		});
+	}
+
+	bool BuildCache::loadBuild(const Key& key, ExecutableInfoRef& exeInfo, std::vector<ModuleInfoRef>& objects) const
+	{
+		std::ifstream iStream;
+		if (!openEntry(key, iStream))
+			return false;
+
+		try
+		{
+			exeInfo = ExecutableInfo::create();
+			deserialize(*exeInfo, iStream);
+
+			uint64_t nObjects = 0;
+			deserialize(nObjects, iStream);
+			objects.clear();
+			for (uint64_t i = 0; i < nObjects && iStream.good(); ++i)
+			{
+				objects.push_back(ModuleInfo::create());
+				deserialize(*objects.back(), iStream);
+			}
+		}
+		catch (const MarCoreError&)
+		{
+			return false;
+		}
+
+		return iStream.good();
+	}
+
+	void BuildCache::storeBuild(const Key& key, const ExecutableInfo& exeInfo, const std::vector<ModuleInfoRef>& objects) const
+	{
+		writeEntry(key, [&](std::ostream& oStream) {
+			serialize(exeInfo, oStream);
+			serialize<uint64_t>(objects.size(), oStream);
+			for (auto& object : objects)
+				serialize(*object, oStream);
+		});
+	}
+
+	std::string BuildCache::defaultDir()
+	{
+		if (auto dir = std::getenv("MARC_CACHE_DIR"); dir && *dir)
+			return dir;
+
+		std::error_code ec;
+		auto tempDir = std::filesystem::temp_directory_path(ec);
+		if (ec)
+			return "";
+		return (tempDir / "MarC" / "cache").string();
+	}
+
+	BuildCacheRef BuildCache::create(const std::string& cacheDir, const std::string& toolID)
+	{
+		return std::make_shared<BuildCache>(cacheDir, toolID);
+	}
+
+	std::string BuildCache::entryPath(const Key& key) const
+	{
+		char name[17];
+		snprintf(name, sizeof(name), "%016llx", (unsigned long long)key.hash);
+		return (std::filesystem::path(m_cacheDir) / (std::string(name) + ".mcache")).string();
+	}
+
+	bool BuildCache::openEntry(const Key& key, std::ifstream& iStream) const
+	{
+		iStream.open(entryPath(key), std::ios::binary | std::ios::in);
+		if (!iStream.is_open())
+			return false;
+
+		CacheEntryHeader header;
+		deserialize(header, iStream);
+		if (!iStream.good() || std::string(header.magic, sizeof(header.magic)) != std::string(CacheEntryHeader().magic, sizeof(header.magic)) || header.version != FormatVersion)
+			return false;
+
+		// The file name is only a 64 bit hash, the full key material decides whether the entry belongs to the key.
+		uint64_t size = 0;
+		deserialize(size, iStream);
+		if (!iStream.good() || size != key.material.size())
+			return false;
+
+		std::string material(size, '\0');
+		iStream.read(material.data(), size);
+
+		return iStream.good() && material == key.material;
+	}
+
+	void BuildCache::writeEntry(const Key& key, const std::function<void(std::ostream&)>& writePayload) const
+	{
+		// The cache is an optimization only, failing to populate it must never fail the build.
+		std::error_code ec;
+		std::filesystem::create_directories(m_cacheDir, ec);
+		if (ec)
+			return;
+
+		// Write to a temporary file and rename it, concurrent readers never see partially written entries.
+		auto path = entryPath(key);
+		auto tempPath = path + "." + std::to_string(std::random_device()()) + ".tmp";
+		{
+			std::ofstream oStream(tempPath, std::ios::binary | std::ios::out | std::ios::trunc);
+			if (!oStream.is_open())
+				return;
+
+			serialize(CacheEntryHeader(), oStream);
+			serialize<uint64_t>(key.material.size(), oStream);
+			oStream.write(key.material.data(), key.material.size());
+			writePayload(oStream);
+
+			if (!oStream.good())
+			{
+				oStream.close();
+				std::filesystem::remove(tempPath, ec);
+				return;
+			}
+		}
+
+		std::filesystem::rename(tempPath, path, ec);
+		if (ec)
+			std::filesystem::remove(tempPath, ec);
+	}
+}
@@ -18,23 +18,33 @@ namespace MarC
 
 	std::string readCodeFile(const std::string& filepath)
 	{
-		std::ifstream f(filepath);
+		std::ifstream f(filepath, std::ios::binary);
 		if (!f.good())
 			throw MarCoreError("FileIOError", "Unable to open the code file!");
 
+		// Read the whole file with a single sized read, the buffer is handed to the tokenizer without further copies.
+		std::error_code ec;
+		uint64_t size = std::filesystem::file_size(filepath, ec);
+		if (ec)
+			throw MarCoreError("FileIOError", "Unable to determine the size of the code file!");
+
 		std::string result;
-		while (!f.eof())
+		result.resize(size);
+		if (!f.read(result.data(), size))
+			throw MarCoreError("FileIOError", "An error occured while reading the input file!");
+
+		// The tokenizer only knows '\n' line endings, collapse "\r\n" in place.
+		if (result.find("\r\n") != std::string::npos)
 		{
-			std::string line;
-			std::getline(f, line);
-			result.append(line);
-			result.push_back('\n');
+			uint64_t j = 0;
+			for (uint64_t i = 0; i < result.size(); ++i)
+			{
+				if (result[i] == '\r' && i + 1 < result.size() && result[i + 1] == '\n')
+					continue;
+				result[j++] = result[i];
+			}
+			result.resize(j);
 		}
-		if (!result.empty())
-			result.pop_back();
-
-		if (f.fail() && !f.eof())
-			throw MarCoreError("FileIOError", "An error occured while reading the input file!");
 
 		return result;
 	}
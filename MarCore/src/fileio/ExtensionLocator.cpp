@@ -1,7 +1,7 @@
 #include "fileio/ExtensionLocator.h"
 
-#include <cstring>
 #include "PluS/Defines.h"
+#include "fileio/FileIndex.h"
 
 #if defined PLUS_BUILD_TYPE_DEBUG
 #define MARC_EXTENSION_POSTFIX "-dbg"
@@ -24,24 +24,13 @@ namespace MarC
 
 		for (auto& baseDir : baseDirs)
 		{
-			for (auto& entry : std::filesystem::recursive_directory_iterator(baseDir))
-			{
-				if (!entry.is_regular_file())
-					continue;
-				if (entry.path().extension().string() != PLUS_PLATFORM_PLUGIN_EXTENSION)
-					continue;
-
-				auto stem = entry.path().stem().string();
-				if (stem.find(MARC_EXTENSION_POSTFIX) != stem.size() - strlen(MARC_EXTENSION_POSTFIX))
-					continue;
-				stem = stem.substr(0, stem.size() - strlen(MARC_EXTENSION_POSTFIX));
+			auto index = FileIndex::get(baseDir);
 
-				auto extMatch = extNames.find(stem);
-				if (extMatch == extNames.end())
-					continue;
-
-				auto& list = locatedExtensions.find(stem)->second;
-				list.insert(std::filesystem::absolute(entry).string());
+			for (auto& [extName, list] : locatedExtensions)
+			{
+				auto paths = index->find(PLUS_PLATFORM_PLUGIN_EXTENSION, extName + MARC_EXTENSION_POSTFIX);
+				if (paths)
+					list.insert(paths->begin(), paths->end());
 			}
 		}
 
@@ -0,0 +1,239 @@
+#include "fileio/FileIndex.h"
+
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <filesystem>
+
+#include "PluS/Defines.h"
+#include "fileio/Serializer.h"
+
+namespace MarC
+{
+	std::mutex FileIndex::s_mtx;
+	std::map<std::string, FileIndexRef> FileIndex::s_indices;
+	std::string FileIndex::s_persistDir;
+
+	struct FileIndexHeader
+	{
+		char magic[8] = { 'M', 'A', 'R', 'C', 'I', 'D', 'X', '\0' };
+		uint64_t version = 1;
+	};
+	MARC_SERIALIZER_ENABLE_FIXED(FileIndexHeader);
+
+	static int64_t lastWriteTime(const std::filesystem::path& path, std::error_code& ec)
+	{
+		return std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+	}
+
+	FileIndex::FileIndex(const std::string& baseDir)
+		: m_baseDir(baseDir)
+	{}
+
+	const std::set<std::string>* FileIndex::find(const std::string& extension, const std::string& stem) const
+	{
+		auto itExt = m_files.find(extension);
+		if (itExt == m_files.end())
+			return nullptr;
+		auto itStem = itExt->second.find(stem);
+		if (itStem == itExt->second.end())
+			return nullptr;
+		return &itStem->second;
+	}
+
+	FileIndexRef FileIndex::get(const std::string& baseDir)
+	{
+		// "dir", "./dir" and "/abs/dir" share one index (and report the same paths).
+		std::error_code ec;
+		auto absDir = std::filesystem::absolute(baseDir, ec);
+		std::string key = ec ? baseDir : std::filesystem::weakly_canonical(absDir, ec).string();
+		if (ec)
+			key = baseDir;
+
+		std::string persistDir;
+		{
+			std::lock_guard lock(s_mtx);
+			auto it = s_indices.find(key);
+			if (it != s_indices.end())
+				return it->second;
+			persistDir = s_persistDir;
+		}
+
+		// Scan without holding the lock, other directories can be indexed concurrently.
+		auto index = std::make_shared<FileIndex>(key);
+		if (persistDir.empty() || !index->loadPersisted(persistDir))
+		{
+			index->scan();
+			if (!persistDir.empty())
+				index->persist(persistDir);
+		}
+
+		std::lock_guard lock(s_mtx);
+		return s_indices.insert({ key, index }).first->second;
+	}
+
+	void FileIndex::setPersistDir(const std::string& dir)
+	{
+		std::lock_guard lock(s_mtx);
+		s_persistDir = dir;
+	}
+
+	void FileIndex::invalidate()
+	{
+		std::lock_guard lock(s_mtx);
+		s_indices.clear();
+	}
+
+	bool FileIndex::isIndexed(const std::string& extension)
+	{
+		return extension == ".mca" || extension == ".mco" || extension == PLUS_PLATFORM_PLUGIN_EXTENSION;
+	}
+
+	void FileIndex::scan()
+	{
+		m_files.clear();
+		m_dirTimes.clear();
+
+		std::error_code ec;
+		if (!std::filesystem::is_directory(m_baseDir, ec))
+			return;
+
+		m_dirTimes.push_back({ m_baseDir, lastWriteTime(m_baseDir, ec) });
+
+		auto options = std::filesystem::directory_options::skip_permission_denied;
+		for (auto it = std::filesystem::recursive_directory_iterator(m_baseDir, options, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+		{
+			auto& entry = *it;
+			std::error_code entryEc;
+			if (entry.is_directory(entryEc))
+			{
+				m_dirTimes.push_back({ entry.path().string(), lastWriteTime(entry.path(), entryEc) });
+				continue;
+			}
+			if (!entry.is_regular_file(entryEc))
+				continue;
+			if (!isIndexed(entry.path().extension().string()))
+				continue;
+
+			addFile(entry.path().string());
+		}
+	}
+
+	void FileIndex::addFile(const std::string& path)
+	{
+		std::filesystem::path p(path);
+		m_files[p.extension().string()][p.stem().string()].insert(path);
+	}
+
+	std::string FileIndex::persistPath(const std::string& persistDir) const
+	{
+		return (std::filesystem::path(persistDir) / ("index-" + std::to_string(std::hash<std::string>()(m_baseDir)) + ".mcidx")).string();
+	}
+
+	bool FileIndex::loadPersisted(const std::string& persistDir)
+	{
+		std::ifstream iStream(persistPath(persistDir), std::ios::binary | std::ios::in);
+		if (!iStream.is_open())
+			return false;
+
+		FileIndexHeader header;
+		deserialize(header, iStream);
+		if (!iStream.good() || std::string(header.magic) != FileIndexHeader().magic || header.version != FileIndexHeader().version)
+			return false;
+
+		std::string baseDir;
+		deserialize(baseDir, iStream);
+		if (baseDir != m_baseDir)
+			return false;
+
+		// Adding, removing or renaming an entry updates the write time of its directory.
+		uint64_t count = 0;
+		deserialize(count, iStream);
+		for (uint64_t i = 0; i < count && iStream.good(); ++i)
+		{
+			std::string dir;
+			int64_t time;
+			deserialize(dir, iStream);
+			deserialize(time, iStream);
+
+			std::error_code ec;
+			if (lastWriteTime(dir, ec) != time || ec)
+			{
+				m_dirTimes.clear();
+				return false;
+			}
+			m_dirTimes.push_back({ dir, time });
+		}
+
+		deserialize(count, iStream);
+		for (uint64_t i = 0; i < count && iStream.good(); ++i)
+		{
+			std::string path;
+			deserialize(path, iStream);
+			addFile(path);
+		}
+
+		if (!iStream.good())
+		{
+			m_files.clear();
+			m_dirTimes.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	void FileIndex::persist(const std::string& persistDir) const
+	{
+		// Directories modified within the file system's timestamp granularity could change again unnoticed.
+		auto threshold = (std::filesystem::file_time_type::clock::now() - std::chrono::seconds(2)).time_since_epoch().count();
+		for (auto& [dir, time] : m_dirTimes)
+		{
+			if (time > threshold)
+				return;
+		}
+
+		std::error_code ec;
+		std::filesystem::create_directories(persistDir, ec);
+		if (ec)
+			return;
+
+		auto path = persistPath(persistDir);
+		auto tempPath = path + "." + std::to_string(std::random_device()()) + ".tmp";
+		{
+			std::ofstream oStream(tempPath, std::ios::binary | std::ios::out | std::ios::trunc);
+			if (!oStream.is_open())
+				return;
+
+			serialize(FileIndexHeader(), oStream);
+			serialize(m_baseDir, oStream);
+			serialize<uint64_t>(m_dirTimes.size(), oStream);
+			for (auto& [dir, time] : m_dirTimes)
+			{
+				serialize(dir, oStream);
+				serialize(time, oStream);
+			}
+
+			uint64_t nFiles = 0;
+			for (auto& [ext, stems] : m_files)
+				for (auto& [stem, paths] : stems)
+					nFiles += paths.size();
+			serialize(nFiles, oStream);
+			for (auto& [ext, stems] : m_files)
+				for (auto& [stem, paths] : stems)
+					for (auto& filePath : paths)
+						serialize(filePath, oStream);
+
+			if (!oStream.good())
+			{
+				oStream.close();
+				std::filesystem::remove(tempPath, ec);
+				return;
+			}
+		}
+
+		std::filesystem::rename(tempPath, path, ec);
+		if (ec)
+			std::filesystem::remove(tempPath, ec);
+	}
+}
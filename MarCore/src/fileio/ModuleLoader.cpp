@@ -4,29 +4,17 @@
 #include "AsmTokenizer.h"
 #include "fileio/CodeFileReader.h"
 
+#include <atomic>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <functional>
+
 namespace MarC
 {
-	ModulePackRef ModuleLoader::load(const std::string& modPath, const std::set<std::string>& modDirs)
-	{
-		ModulePackRef mod = std::make_shared<ModulePack>();
-
-		mod->name = modNameFromPath(modPath);
-
-		std::string source = readCodeFile(modPath);
-
-		AsmTokenizer tokenizer(source);
-
-		if (!tokenizer.tokenize())
-			throw tokenizer.lastError();
-
-		mod->tokenList = tokenizer.getTokenList();
-
-		loadDependencies(mod->tokenList, mod->dependencies, modDirs);
-
-		return mod;
-	}
-
-	void ModuleLoader::loadDependencies(AsmTokenListRef tokenList, std::map<std::string, AsmTokenListRef>& dependencies, const std::set<std::string>& modDirs)
+	// Collects the names of all modules requested with '#reqmod' at the beginning of a line.
+	static std::set<std::string> scanRequiredModules(const AsmTokenList& tokenList)
 	{
 		std::set<std::string> modNames;
 
@@ -40,9 +28,9 @@ namespace MarC
 			Find_EndNewline,
 		} state = State::Find_Directive;
 
-		for (uint64_t i = 0; i < tokenList->size(); ++i)
+		for (uint64_t i = 0; i < tokenList.size(); ++i)
 		{
-			auto& token = (*tokenList)[i];
+			auto& token = tokenList[i];
 			switch (state)
 			{
 			case State::Find_BeginNewline:
@@ -67,7 +55,7 @@ namespace MarC
 			case State::Find_ModName:
 				if (token.type != AsmToken::Type::String)
 					throw MarCoreError("Expected module name after directive 'reqmod'!");
-				modNames.insert(token.value);
+				modNames.insert(std::string(token.value));
 				state = State::Find_EndNewline;
 				break;
 			case State::Find_EndNewline:
@@ -81,28 +69,105 @@ namespace MarC
 			}
 		}
 
-		auto found = locateModules(modDirs, modNames);
+		return modNames;
+	}
+
+	static AsmTokenListRef tokenizeFile(const std::string& path)
+	{
+		AsmTokenizer tokenizer(readCodeFile(path));
+
+		if (!tokenizer.tokenize())
+			throw tokenizer.lastError();
 
-		for (auto& f : found)
+		return tokenizer.getTokenList();
+	}
+
+	// Runs 'job' for every index in [0, n) on up to one thread per core, the calling thread works as well.
+	static void parallelFor(uint64_t n, const std::function<void(uint64_t)>& job)
+	{
+		std::atomic<uint64_t> next = 0;
+		auto worker = [&]()
 		{
-			if (dependencies.find(f.first) != dependencies.end())
-				continue;
+			for (uint64_t i = next++; i < n; i = next++)
+				job(i);
+		};
+
+		uint64_t nThreads = std::min<uint64_t>(n, std::max(1u, std::thread::hardware_concurrency()));
+		std::vector<std::thread> threads;
+		for (uint64_t i = 1; i < nThreads; ++i)
+			threads.emplace_back(worker);
+		worker();
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	ModulePackRef ModuleLoader::load(const std::string& modPath, const std::set<std::string>& modDirs)
+	{
+		ModulePackRef mod = std::make_shared<ModulePack>();
+
+		mod->name = modNameFromPath(modPath);
 
-			if (f.second.empty())
-				throw MarCoreError("ModuleLoadError", "Unable to find module '" + f.first + "'!");
-			if (f.second.size() > 1)
-				throw MarCoreError("ModuleLoadError", "The module name '" + f.first + "' is ambigious!");
-		
-			std::string source = readCodeFile(*f.second.begin());
+		mod->tokenList = tokenizeFile(modPath);
 
-			AsmTokenizer tokenizer(source);
-			
-			if (!tokenizer.tokenize())
-				throw tokenizer.lastError();
+		loadDependencies(mod->tokenList, mod->dependencies, modDirs);
 
-			dependencies.insert({ f.first, tokenizer.getTokenList() });
+		return mod;
+	}
 
-			loadDependencies(tokenizer.getTokenList(), dependencies, modDirs);
+	void ModuleLoader::loadDependencies(AsmTokenListRef tokenList, std::map<std::string, AsmTokenListRef>& dependencies, const std::set<std::string>& modDirs)
+	{
+		// The dependency graph is walked breadth-first, all modules first required on the same level are read and tokenized concurrently.
+		auto modNames = scanRequiredModules(*tokenList);
+
+		while (!modNames.empty())
+		{
+			auto found = locateModules(modDirs, modNames);
+
+			std::vector<std::pair<std::string, std::string>> jobs;
+			for (auto& f : found)
+			{
+				if (dependencies.find(f.first) != dependencies.end())
+					continue;
+
+				if (f.second.empty())
+					throw MarCoreError("ModuleLoadError", "Unable to find module '" + f.first + "'!");
+				if (f.second.size() > 1)
+					throw MarCoreError("ModuleLoadError", "The module name '" + f.first + "' is ambigious!");
+
+				jobs.push_back({ f.first, *f.second.begin() });
+			}
+
+			std::vector<AsmTokenListRef> results(jobs.size());
+			std::vector<std::exception_ptr> errors(jobs.size());
+			parallelFor(jobs.size(), [&](uint64_t i)
+			{
+				try
+				{
+					results[i] = tokenizeFile(jobs[i].second);
+				}
+				catch (...)
+				{
+					errors[i] = std::current_exception();
+				}
+			});
+
+			for (auto& error : errors)
+			{
+				if (error)
+					std::rethrow_exception(error);
+			}
+
+			modNames.clear();
+			for (uint64_t i = 0; i < jobs.size(); ++i)
+			{
+				dependencies.insert({ jobs[i].first, results[i] });
+
+				for (auto& modName : scanRequiredModules(*results[i]))
+				{
+					if (dependencies.find(modName) == dependencies.end())
+						modNames.insert(modName);
+				}
+			}
 		}
 	}
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #include "fileio/ModuleLocator.h"
 
+#include "fileio/FileIndex.h"
+
 namespace MarC
 {
-	std::map<std::string, std::set<std::string>> locateModules(const std::set<std::string>& baseDirs, const std::set<std::string>& modNames)
+	std::map<std::string, std::set<std::string>> locateModules(const std::set<std::string>& baseDirs, const std::set<std::string>& modNames, const std::string& extension)
 	{
 		std::map<std::string, std::set<std::string>> locatedModules;
 
@@ -11,21 +13,13 @@ namespace MarC
 
 		for (auto& baseDir : baseDirs)
 		{
-			for (auto& entry : std::filesystem::recursive_directory_iterator(baseDir))
-			{
-				if (!entry.is_regular_file())
-					continue;
-				if (entry.path().extension().string() != ".mca")
-					continue;
-
-				auto stem = entry.path().stem().string();
+			auto index = FileIndex::get(baseDir);
 
-				auto modMatch = modNames.find(stem);
-				if (modMatch == modNames.end())
-					continue;
-
-				auto& list = locatedModules.find(stem)->second;
-				list.insert(std::filesystem::absolute(entry).string());
+			for (auto& [modName, list] : locatedModules)
+			{
+				auto paths = index->find(extension, modName);
+				if (paths)
+					list.insert(paths->begin(), paths->end());
 			}
 		}
 
@@ -0,0 +1,140 @@
+#include "fileio/ObjectLoader.h"
+
+#include <fstream>
+#include <filesystem>
+
+#include "fileio/ModuleLocator.h"
+#include "fileio/CodeFileReader.h"
+#include "errors/MarCoreError.h"
+
+namespace MarC
+{
+	static void appendHashField(std::string& material, const std::string& field)
+	{
+		uint64_t size = field.size();
+		material.append((const char*)&size, sizeof(size));
+		material.append(field);
+	}
+
+	// Token positions end up in error messages and exported macros.
+	static void appendHashTokens(std::string& material, const std::vector<AsmToken>& tokens)
+	{
+		appendHashField(material, std::to_string(tokens.size()));
+		for (auto& token : tokens)
+		{
+			material.append((const char*)&token.line, sizeof(token.line));
+			material.append((const char*)&token.column, sizeof(token.column));
+			material.append((const char*)&token.type, sizeof(token.type));
+			material.append((const char*)&token.pragmaIndex, sizeof(token.pragmaIndex));
+			appendHashField(material, std::string(token.value));
+		}
+	}
+
+	static void appendHashInterfaces(std::string& material, const std::vector<ModuleInfoRef>& objects)
+	{
+		for (auto& object : objects)
+		{
+			appendHashField(material, object->exeInfo->name);
+			appendHashField(material, std::to_string(object->interfaceHash));
+		}
+	}
+
+	static uint64_t hashFNV1a(const std::string& data)
+	{
+		uint64_t hash = 0xcbf29ce484222325;
+		for (unsigned char c : data)
+		{
+			hash ^= c;
+			hash *= 0x100000001b3;
+		}
+		return hash;
+	}
+
+	ModuleInfoRef ObjectLoader::load(const std::string& objPath)
+	{
+		std::ifstream iStream(objPath, std::ios::binary | std::ios::in);
+		if (!iStream.is_open())
+			throw MarCoreError("ObjectLoadError", "Unable to open the object file '" + objPath + "'!");
+
+		auto object = ModuleInfo::create();
+
+		deserialize(*object, iStream);
+
+		if (!iStream.good())
+			throw MarCoreError("ObjectLoadError", "An error occured while reading the object file '" + objPath + "'!");
+
+		return object;
+	}
+
+	void ObjectLoader::save(const ModuleInfo& object, const std::string& objPath)
+	{
+		std::ofstream oStream(objPath, std::ios::binary | std::ios::out | std::ios::trunc);
+		if (!oStream.is_open())
+			throw MarCoreError("ObjectSaveError", "Unable to open the object file '" + objPath + "'!");
+
+		serialize(object, oStream);
+
+		if (!oStream.good())
+			throw MarCoreError("ObjectSaveError", "An error occured while writing the object file '" + objPath + "'!");
+	}
+
+	std::vector<ModuleInfoRef> ObjectLoader::loadWithDependencies(const std::string& objPath, const std::set<std::string>& modDirs)
+	{
+		std::set<std::string> searchDirs = modDirs;
+		searchDirs.insert(std::filesystem::absolute(objPath).parent_path().string());
+
+		std::vector<ModuleInfoRef> objects;
+		std::set<std::string> loaded;
+
+		auto addWithDependencies = [&](auto& self, ModuleInfoRef object) -> void {
+			std::set<std::string> modNames(object->requiredModules.begin(), object->requiredModules.end());
+			auto found = locateModules(searchDirs, modNames, ".mco");
+			for (auto& modName : object->requiredModules)
+			{
+				if (loaded.find(modName) != loaded.end())
+					continue;
+
+				auto& paths = found[modName];
+				if (paths.empty())
+					throw MarCoreError("ObjectLoadError", "Unable to find the object of module '" + modName + "'!");
+				if (paths.size() > 1)
+					throw MarCoreError("ObjectLoadError", "The module name '" + modName + "' is ambigious!");
+
+				loaded.insert(modName);
+				self(self, load(*paths.begin()));
+			}
+			objects.push_back(object);
+		};
+
+		loaded.insert(modNameFromPath(objPath));
+		addWithDependencies(addWithDependencies, load(objPath));
+
+		return objects;
+	}
+
+	uint64_t ObjectLoader::sourceHash(const AsmTokenList& tokenList, BC_CodeEncoding encoding, const std::vector<ModuleInfoRef>& requiredObjects)
+	{
+		std::string material;
+		appendHashField(material, std::to_string((uint64_t)encoding));
+		appendHashTokens(material, tokenList);
+		appendHashInterfaces(material, requiredObjects);
+
+		return hashFNV1a(material);
+	}
+
+	uint64_t ObjectLoader::interfaceHash(const ModuleInfo& object, const std::vector<ModuleInfoRef>& requiredObjects)
+	{
+		std::string material;
+		for (auto& [name, macro] : object.macros)
+		{
+			if (object.importedMacros.find(name) != object.importedMacros.end())
+				continue;
+			appendHashField(material, name);
+			appendHashTokens(material, macro.parameters);
+			appendHashTokens(material, macro.tokenList);
+		}
+		appendHashInterfaces(material, requiredObjects);
+
+		return hashFNV1a(material);
+	}
+}
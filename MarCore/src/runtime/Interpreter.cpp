@@ -1,8 +1,10 @@
 #include "runtime/Interpreter.h"
 
+#include <cstring>
 #include <algorithm>
 #include <unordered_map>
 
+#include "Disassembler.h"
 #include "fileio/ExtensionLocator.h"
 #include "runtime/ExternalFunction.h"
 #include "types/BytecodeTypes.h"
@@ -20,68 +22,30 @@ namespace MarC
 		m_extDirs.insert(path);
 	}
 
-	bool Interpreter::interpret(uint64_t nInstructions)
+	bool Interpreter::prepare()
 	{
 		resetError();
 
 		recalcExeMem();
-		
+
 		try
 		{
-			while (nInstructions--)
+			loadMissingExtensions();
+
+			auto& codeMem = m_pExeInfo->codeMemory;
+			auto code = Disassembler::paddedCode(codeMem);
+			uint64_t offset = 0;
+			while (offset < codeMem.size())
 			{
-				if (reachedEndOfCode())
-					throw InterpreterError(IntErrCode::AbortViaEndOfCode, "EOC");
-
-				const auto& ocx = readDataAndMove<BC_OpCodeEx>();
-
-				switch (ocx.opCode)
-				{
-				case BC_OC_NONE:  exec_insUndefined(ocx); break;
-				case BC_OC_UNKNOWN: exec_insUndefined(ocx); break;
-
-				case BC_OC_MOVE: exec_insMove(ocx); break;
-				case BC_OC_ADD: exec_insAdd(ocx); break;
-				case BC_OC_SUBTRACT: exec_insSubtract(ocx); break;
-				case BC_OC_MULTIPLY: exec_insMultiply(ocx); break;
-				case BC_OC_DIVIDE: exec_insDivide(ocx); break;
-				case BC_OC_INCREMENT: exec_insIncrement(ocx); break;
-				case BC_OC_DECREMENT: exec_insDecrement(ocx); break;
-				case BC_OC_SET_ADDRESS_BASE: exec_insSetAddressBase(ocx); break;
-
-				case BC_OC_CONVERT: exec_insConvert(ocx); break;
-
-				case BC_OC_PUSH: exec_insPush(ocx); break;
-				case BC_OC_POP: exec_insPop(ocx); break;
-				case BC_OC_PUSH_N_BYTES: exec_insPushNBytes(ocx); break;
-				case BC_OC_POP_N_BYTES: exec_insPopNBytes(ocx); break;
-				case BC_OC_PUSH_COPY: exec_insPushCopy(ocx); break;
-				case BC_OC_POP_COPY: exec_insPopCopy(ocx); break;
-
-				case BC_OC_PUSH_FRAME: exec_insPushFrame(ocx); break;
-				case BC_OC_POP_FRAME: exec_insPopFrame(ocx); break;
-
-				case BC_OC_JUMP: exec_insJump(ocx); break;
-				case BC_OC_JUMP_EQUAL: exec_insJumpEqual(ocx); break;
-				case BC_OC_JUMP_NOT_EQUAL: exec_insJumpNotEqual(ocx); break;
-				case BC_OC_JUMP_LESS_THAN: exec_insJumpLessThan(ocx); break;
-				case BC_OC_JUMP_GREATER_THAN: exec_insJumpGreaterThan(ocx); break;
-				case BC_OC_JUMP_LESS_EQUAL: exec_insJumpLessEqual(ocx); break;
-				case BC_OC_JUMP_GREATER_EQUAL: exec_insJumpGreaterEqual(ocx); break;
-
-				case BC_OC_ALLOCATE: exec_insAllocate(ocx); break;
-				case BC_OC_FREE: exec_insFree(ocx); break;
-
-				case BC_OC_CALL_EXTERN: exec_insCallExtern(ocx); break;
-
-				case BC_OC_CALL: exec_insCall(ocx); break;
-				case BC_OC_RETURN: exec_insReturn(ocx); break;
-
-				case BC_OC_EXIT: exec_insExit(ocx); break;
-				default:
-					exec_insUndefined(ocx);
-				}
-				++m_nInsExecuted;
+				DisAsmInsInfo daii;
+				// Broken code fails when (and if) it gets executed.
+				if (Disassembler::disassembleChecked(code, codeMem.size(), offset, m_pExeInfo->codeEncoding, daii) != DisAsmCheck::Ok)
+					break;
+				offset = BC_AlignOffset(offset + daii.rawData.size(), BC_InstructionAlignment(m_pExeInfo->codeEncoding));
+
+				// Function names read through a pointer are only known at runtime.
+				if (daii.ocx.opCode == BC_OC_CALL_EXTERN && daii.args[0].derefCount == 0)
+					bindExternalFunction(daii.args[0].value.cell.as_ADDR);
 			}
 		}
 		catch (const InterpreterError& ie)
@@ -92,6 +56,28 @@ namespace MarC
 		return !lastError();
 	}
 
+	void Interpreter::setUnchecked(bool unchecked)
+	{
+		m_unchecked = unchecked;
+		m_sentinelCode = Memory();
+
+		if (unchecked)
+		{
+			// The zeroed bytes read as a 'BC_OC_NONE' instruction, also behind the padding of aligned code.
+			auto& codeMem = m_pExeInfo->codeMemory;
+			m_sentinelCode.resize(BC_AlignOffset(codeMem.size(), BC_InstructionAlignment(BC_CodeEncoding::Aligned)) + sizeof(BC_OpCodeEx));
+			memcpy(m_sentinelCode.getBaseAddress(), codeMem.getBaseAddress(), codeMem.size());
+		}
+
+		recalcExeMem();
+	}
+
+	bool Interpreter::interpret(uint64_t nInstructions)
+	{
+		NullObserver observer;
+		return interpret(nInstructions, observer);
+	}
+
 	bool Interpreter::isGrantedPerm(const std::string& name) const
 	{
 		return m_grantedPermissions.find(name) != m_grantedPermissions.end();
@@ -171,7 +157,7 @@ namespace MarC
 	void Interpreter::recalcExeMem()
 	{
 		m_mem.codeMemSize = m_pExeInfo->codeMemory.size();
-		m_mem.baseTable[BC_MEM_BASE_CODE_MEMORY] = m_pExeInfo->codeMemory.getBaseAddress();
+		m_mem.baseTable[BC_MEM_BASE_CODE_MEMORY] = m_unchecked ? m_sentinelCode.getBaseAddress() : m_pExeInfo->codeMemory.getBaseAddress();
 		m_mem.baseTable[BC_MEM_BASE_STATIC_STACK] = m_pExeInfo->staticStack.getBaseAddress();
 	}
 
@@ -199,38 +185,62 @@ namespace MarC
 		}
 	}
 
+	void Interpreter::bindExternalFunction(BC_MemAddress funcAddr)
+	{
+		if (m_extFuncs.find(funcAddr) != m_extFuncs.end())
+			return;
+
+		// Names outside of the static data resolve when (and if) the call gets executed.
+		auto& staticStack = m_pExeInfo->staticStack;
+		if (funcAddr.base != BC_MEM_BASE_STATIC_STACK || funcAddr.addr < 0 || (uint64_t)funcAddr.addr >= staticStack.size() ||
+			!memchr((const char*)staticStack.getBaseAddress() + funcAddr.addr, '\0', staticStack.size() - funcAddr.addr))
+			return;
+
+		std::string funcName = &hostObject<char>(funcAddr);
+		if (!isGrantedPerm(funcName))
+			return;
+
+		// Unknown functions are reported when (and if) they get called.
+		auto uid = PluS::PluginManager::get().findFeature(funcName);
+		if (uid)
+			m_extFuncs.insert({ funcAddr, PluS::PluginManager::get().createFeature<ExternalFunction>(uid) });
+	}
+
 	void Interpreter::exec_insUndefined(BC_OpCodeEx ocx)
 	{
+		// Unchecked runs end at the sentinel behind the code.
+		if (m_unchecked && ocx.opCode == BC_OC_NONE && getRegister(BC_MEM_REG_CODE_POINTER).as_ADDR.addr - (int64_t)sizeof(BC_OpCodeEx) >= (int64_t)m_mem.codeMemSize)
+			throw InterpreterError(IntErrCode::AbortViaEndOfCode, "EOC");
 		throw InterpreterError(IntErrCode::OpCodeUnknown, std::to_string(ocx.opCode));
 	}
 
-	void Interpreter::exec_insAdd(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insAdd(BC_OpCodeEx ocx)
 	{
-		auto& dest = hostMemCell(readDataAndMove<BC_MemAddress>(), ocx.derefArg[0]);
-		auto& src = readMemCellAndMove(ocx.datatype, ocx.derefArg[1]);
+		auto& dest = hostMemCell(readAddressAndMove<Encoding>(), ocx.derefArg[0]);
+		auto& src = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[1]);
 		MARC_INTERPRETER_BINARY_OP(dest, +=, src, ocx.datatype);
 	}
-	void Interpreter::exec_insSubtract(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insSubtract(BC_OpCodeEx ocx)
 	{
-		auto& dest = hostMemCell(readDataAndMove<BC_MemAddress>(), ocx.derefArg[0]);
-		auto& src = readMemCellAndMove(ocx.datatype, ocx.derefArg[1]);
+		auto& dest = hostMemCell(readAddressAndMove<Encoding>(), ocx.derefArg[0]);
+		auto& src = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[1]);
 		MARC_INTERPRETER_BINARY_OP(dest, -=, src, ocx.datatype);
 	}
-	void Interpreter::exec_insMultiply(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insMultiply(BC_OpCodeEx ocx)
 	{
-		auto& dest = hostMemCell(readDataAndMove<BC_MemAddress>(), ocx.derefArg[0]);
-		auto& src = readMemCellAndMove(ocx.datatype, ocx.derefArg[1]);
+		auto& dest = hostMemCell(readAddressAndMove<Encoding>(), ocx.derefArg[0]);
+		auto& src = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[1]);
 		MARC_INTERPRETER_BINARY_OP(dest, *=, src, ocx.datatype);
 	}
-	void Interpreter::exec_insDivide(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insDivide(BC_OpCodeEx ocx)
 	{
-		auto& dest = hostMemCell(readDataAndMove<BC_MemAddress>(), ocx.derefArg[0]);
-		auto& src = readMemCellAndMove(ocx.datatype, ocx.derefArg[1]);
+		auto& dest = hostMemCell(readAddressAndMove<Encoding>(), ocx.derefArg[0]);
+		auto& src = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[1]);
 		MARC_INTERPRETER_BINARY_OP(dest, /=, src, ocx.datatype);
 	}
-	void Interpreter::exec_insIncrement(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insIncrement(BC_OpCodeEx ocx)
 	{
-		auto& dest = hostMemCell(readDataAndMove<BC_MemAddress>(), ocx.derefArg[0]);
+		auto& dest = hostMemCell(readAddressAndMove<Encoding>(), ocx.derefArg[0]);
 		switch(ocx.datatype)
 		{
 		case BC_DT_NONE: break;
@@ -249,9 +259,9 @@ namespace MarC
 		case BC_DT_DATATYPE: break;
 		}
 	}
-	void Interpreter::exec_insDecrement(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insDecrement(BC_OpCodeEx ocx)
 	{
-		auto& dest = hostMemCell(readDataAndMove<BC_MemAddress>(), ocx.derefArg[0]);
+		auto& dest = hostMemCell(readAddressAndMove<Encoding>(), ocx.derefArg[0]);
 		switch(ocx.datatype)
 		{
 		case BC_DT_NONE: break;
@@ -270,17 +280,17 @@ namespace MarC
 		case BC_DT_DATATYPE: break;
 		}
 	}
-	void Interpreter::exec_insSetAddressBase(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insSetAddressBase(BC_OpCodeEx ocx)
 	{
-		auto& dest = hostMemCell(readDataAndMove<BC_MemAddress>(), ocx.derefArg[0]);
-		auto& addr = readMemCellAndMove(BC_DT_ADDR, ocx.derefArg[1]);
+		auto& dest = hostMemCell(readAddressAndMove<Encoding>(), ocx.derefArg[0]);
+		auto& addr = readMemCellAndMove<Encoding>(BC_DT_ADDR, ocx.derefArg[1]);
 		dest.as_ADDR.base = addr.as_ADDR.base;
 	}
-	void Interpreter::exec_insJumpEqual(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insJumpEqual(BC_OpCodeEx ocx)
 	{
-		auto& destAddr = readMemCellAndMove(BC_DT_ADDR, ocx.derefArg[0]);
-		auto& leftOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[1]);
-		auto& rightOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[2]);
+		auto& destAddr = readMemCellAndMove<Encoding>(BC_DT_ADDR, ocx.derefArg[0]);
+		auto& leftOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[1]);
+		auto& rightOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[2]);
 
 		bool result = false;
 
@@ -288,11 +298,11 @@ namespace MarC
 
 		getRegister(BC_MEM_REG_CODE_POINTER) = result ? destAddr : getRegister(BC_MEM_REG_CODE_POINTER);
 	}
-	void Interpreter::exec_insJumpNotEqual(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insJumpNotEqual(BC_OpCodeEx ocx)
 	{
-		auto& destAddr = readMemCellAndMove(BC_DT_ADDR, ocx.derefArg[0]);
-		auto& leftOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[1]);
-		auto& rightOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[2]);
+		auto& destAddr = readMemCellAndMove<Encoding>(BC_DT_ADDR, ocx.derefArg[0]);
+		auto& leftOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[1]);
+		auto& rightOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[2]);
 
 		bool result = false;
 
@@ -300,11 +310,11 @@ namespace MarC
 
 		getRegister(BC_MEM_REG_CODE_POINTER) = result ? destAddr : getRegister(BC_MEM_REG_CODE_POINTER);
 	}
-	void Interpreter::exec_insJumpLessThan(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insJumpLessThan(BC_OpCodeEx ocx)
 	{
-		auto& destAddr = readMemCellAndMove(BC_DT_ADDR, ocx.derefArg[0]);
-		auto& leftOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[1]);
-		auto& rightOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[2]);
+		auto& destAddr = readMemCellAndMove<Encoding>(BC_DT_ADDR, ocx.derefArg[0]);
+		auto& leftOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[1]);
+		auto& rightOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[2]);
 
 		bool result = false;
 
@@ -312,11 +322,11 @@ namespace MarC
 
 		getRegister(BC_MEM_REG_CODE_POINTER) = result ? destAddr : getRegister(BC_MEM_REG_CODE_POINTER);
 	}
-	void Interpreter::exec_insJumpGreaterThan(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insJumpGreaterThan(BC_OpCodeEx ocx)
 	{
-		auto& destAddr = readMemCellAndMove(BC_DT_ADDR, ocx.derefArg[0]);
-		auto& leftOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[1]);
-		auto& rightOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[2]);
+		auto& destAddr = readMemCellAndMove<Encoding>(BC_DT_ADDR, ocx.derefArg[0]);
+		auto& leftOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[1]);
+		auto& rightOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[2]);
 
 		bool result = false;
 
@@ -324,11 +334,11 @@ namespace MarC
 
 		getRegister(BC_MEM_REG_CODE_POINTER) = result ? destAddr : getRegister(BC_MEM_REG_CODE_POINTER);
 	}
-	void Interpreter::exec_insJumpLessEqual(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insJumpLessEqual(BC_OpCodeEx ocx)
 	{
-		auto& destAddr = readMemCellAndMove(BC_DT_ADDR, ocx.derefArg[0]);
-		auto& leftOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[1]);
-		auto& rightOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[2]);
+		auto& destAddr = readMemCellAndMove<Encoding>(BC_DT_ADDR, ocx.derefArg[0]);
+		auto& leftOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[1]);
+		auto& rightOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[2]);
 
 		bool result = false;
 
@@ -336,11 +346,11 @@ namespace MarC
 
 		getRegister(BC_MEM_REG_CODE_POINTER) = result ? destAddr : getRegister(BC_MEM_REG_CODE_POINTER);
 	}
-	void Interpreter::exec_insJumpGreaterEqual(BC_OpCodeEx ocx)
+	template <BC_CodeEncoding Encoding> void Interpreter::exec_insJumpGreaterEqual(BC_OpCodeEx ocx)
 	{
-		auto& destAddr = readMemCellAndMove(BC_DT_ADDR, ocx.derefArg[0]);
-		auto& leftOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[1]);
-		auto& rightOperand = readMemCellAndMove(ocx.datatype, ocx.derefArg[2]);
+		auto& destAddr = readMemCellAndMove<Encoding>(BC_DT_ADDR, ocx.derefArg[0]);
+		auto& leftOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[1]);
+		auto& rightOperand = readMemCellAndMove<Encoding>(ocx.datatype, ocx.derefArg[2]);
 
 		bool result = false;
 
@@ -348,61 +358,34 @@ namespace MarC
 
 		getRegister(BC_MEM_REG_CODE_POINTER) = result ? destAddr : getRegister(BC_MEM_REG_CODE_POINTER);
 	}
-	void Interpreter::exec_insAllocate(BC_OpCodeEx ocx)
-	{
-		auto& addr = hostMemCell(readDataAndMove<BC_MemAddress>(), ocx.derefArg[0]).as_ADDR;
-		addr = BC_MemAddress(BC_MEM_BASE_NONE, 0);
-		uint64_t size = readMemCellAndMove(BC_DT_U_64, ocx.derefArg[1]).as_U_64;
-		void* ptr = malloc(size);
-		if (!ptr)
-			return;
-		addr = BC_MemAddress(BC_MEM_BASE_EXTERN, m_mem.nextDynAddr);
-		m_mem.dynMemMap.insert({ addr, ptr });
-		m_mem.nextDynAddr += size;
-	}
-	void Interpreter::exec_insFree(BC_OpCodeEx ocx)
-	{
-		auto& addr = readMemCellAndMove(BC_DT_ADDR, ocx.derefArg[0]).as_ADDR;
-		auto it = m_mem.dynMemMap.find(addr);
-		if (it != m_mem.dynMemMap.end())
-			free(it->second);
-		m_mem.dynMemMap.erase(addr);
-	}
-	void Interpreter::exec_insCallExtern(BC_OpCodeEx ocx)
-	{
-		uint64_t argIndex = 0;
-
-		BC_MemAddress funcNameAddr = readMemCellAndMove(BC_DT_ADDR, ocx.derefArg[argIndex++]).as_ADDR;
-		auto& fcd = readDataAndMove<BC_FuncCallData>();
-
-		ExternalFunctionPtr func = getExternalFunction(funcNameAddr);
-
-		ExFuncData efd;
-		efd.retVal.datatype = ocx.datatype;
-		efd.nParams = fcd.nArgs;
-
-		void* retDest = nullptr;
-		if (ocx.datatype != BC_DT_NONE)
-			retDest = hostAddress(readDataAndMove<BC_MemAddress>(), ocx.derefArg[argIndex++]);
-
-		for (uint8_t i = 0; i < fcd.nArgs; ++i)
-		{
-			auto dt = fcd.argType.get(i);
-			efd.param[i].datatype = dt;
-			efd.param[i].cell = readMemCellAndMove(dt, ocx.derefArg.get(argIndex++));
-		}
-
-		func->call(*this, efd);
-
-		if (retDest)
-			memcpy(retDest, &efd.retVal.cell, BC_DatatypeSize(efd.retVal.datatype));
-	}
 	void Interpreter::exec_insExit(BC_OpCodeEx ocx)
 	{
 		UNUSED(ocx);
 		throw InterpreterError(IntErrCode::AbortViaExit, "EXIT");
 	}
 
+	// run() gets instantiated by the callers of interpret(), the instructions defined here exist for every encoding.
+#define MARC_INTERPRETER_INSTANTIATE_INS(__ins) \
+	template void Interpreter::__ins<BC_CodeEncoding::Packed>(BC_OpCodeEx ocx); \
+	template void Interpreter::__ins<BC_CodeEncoding::Aligned>(BC_OpCodeEx ocx); \
+	template void Interpreter::__ins<BC_CodeEncoding::Compact>(BC_OpCodeEx ocx)
+
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insAdd);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insSubtract);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insMultiply);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insDivide);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insIncrement);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insDecrement);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insSetAddressBase);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insJumpEqual);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insJumpNotEqual);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insJumpLessThan);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insJumpGreaterThan);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insJumpLessEqual);
+	MARC_INTERPRETER_INSTANTIATE_INS(exec_insJumpGreaterEqual);
+
+#undef MARC_INTERPRETER_INSTANTIATE_INS
+
 	ExternalFunctionPtr Interpreter::getExternalFunction(BC_MemAddress funcAddr)
 	{
 		auto funcIt = m_extFuncs.find(funcAddr);
@@ -4,6 +4,33 @@
 
 namespace MarC
 {
+	const std::string& AsmStringStore::own(std::string buffer)
+	{
+		// Elements of a deque don't move when new ones get appended
+		m_buffers.push_back(std::move(buffer));
+		return m_buffers.back();
+	}
+
+	std::string_view AsmStringStore::intern(std::string str)
+	{
+		// Node based container, the stored strings never move
+		return *m_interned.insert(std::move(str)).first;
+	}
+
+	void AsmTokenList::retain(const AsmStringStoreRef& store)
+	{
+		for (auto& elem : m_stores)
+			if (elem == store)
+				return;
+		m_stores.push_back(store);
+	}
+
+	void AsmTokenList::retain(const AsmTokenList& other)
+	{
+		for (auto& store : other.m_stores)
+			retain(store);
+	}
+
 	std::string AsmTokenTypeToString(AsmToken::Type tt)
 	{
 		std::map<AsmToken::Type, std::string> ttMap = {
@@ -2,7 +2,7 @@
 
 namespace MarC
 {
-	DirectiveID DirectiveIDFromString(const std::string& value)
+	DirectiveID DirectiveIDFromString(std::string_view value)
 	{
 		if (value == "") return DirectiveID::None;
 		if (value == "label") return DirectiveID::Label;
@@ -24,4 +24,34 @@ namespace MarC
 
 		return DirectiveID::Unknown;
 	}
+
+	SymbolID SymbolNameTable::intern(std::string_view name)
+	{
+		auto it = m_ids.find(name);
+		if (it != m_ids.end())
+			return it->second;
+
+		SymbolID id = (SymbolID)m_names.size();
+		m_names.emplace_back(name);
+		m_ids.insert({ m_names.back(), id });
+		return id;
+	}
+
+	SymbolID SymbolNameTable::find(std::string_view name) const
+	{
+		auto it = m_ids.find(name);
+		if (it == m_ids.end())
+			return InvalidSymbolID;
+		return it->second;
+	}
+
+	const std::string& SymbolNameTable::name(SymbolID id) const
+	{
+		return m_names[id];
+	}
+
+	uint64_t SymbolNameTable::size() const
+	{
+		return m_names.size();
+	}
 }
\ No newline at end of file
@@ -4,9 +4,9 @@
 
 namespace MarC
 {
-	BC_OpCode BC_OpCodeFromString(const std::string& ocStr)
+	BC_OpCode BC_OpCodeFromString(std::string_view ocStr)
 	{
-		static const std::map<std::string, BC_OpCode> ocMap = {
+		static const std::map<std::string, BC_OpCode, std::less<>> ocMap = {
 			{ "",        BC_OC_NONE },
 
 			{ "mov",     BC_OC_MOVE },
@@ -107,9 +107,9 @@ namespace MarC
 		return it->second;
 	}
 
-	BC_Datatype BC_DatatypeFromString(const std::string& dtStr)
+	BC_Datatype BC_DatatypeFromString(std::string_view dtStr)
 	{
-		static const std::map<std::string, BC_Datatype> dtMap = {
+		static const std::map<std::string, BC_Datatype, std::less<>> dtMap = {
 			{ "none", BC_DT_NONE },
 			{ "i8",   BC_DT_I_8  },
 			{ "i16",  BC_DT_I_16 },
@@ -152,9 +152,9 @@ namespace MarC
 		return it->second;
 	}
 
-	BC_MemRegister BC_RegisterFromString(const std::string& regStr)
+	BC_MemRegister BC_RegisterFromString(std::string_view regStr)
 	{
-		static const std::map<std::string, BC_MemRegister> regMap = {
+		static const std::map<std::string, BC_MemRegister, std::less<>> regMap = {
 			{ "",        BC_MEM_REG_NONE           },
 			{ "cp",      BC_MEM_REG_CODE_POINTER   },
 			{ "sp",      BC_MEM_REG_STACK_POINTER  },
@@ -26,7 +26,8 @@ import os
 from os import path
 import subprocess
 import shlex
-from typing import List, BinaryIO, Tuple, Optional
+import tempfile
+from typing import List, Dict, BinaryIO, Tuple, Optional
 from dataclasses import dataclass, field
 
 def cmd_run_echoed(cmd, **kwargs):
@@ -68,6 +69,18 @@ class TestCase:
 
 DEFAULT_TEST_CASE=TestCase(argv=[], stdin=bytes(), returncode=0, stdout=bytes(), stderr=bytes())
 
+# Besides being interpreted, every test gets built (one object per module) and run with each of these option sets.
+# The output has to match '<test>.txt', or '<test>.<name>.txt' if it exists (e.g. for tests that print code addresses).
+# Tests without a '<test>.txt' only run with the option sets they have a '<test>.<name>.txt' for (e.g. tests that need -O2).
+BUILD_OPTIONS: Dict[str, List[str]] = {
+    "build": [],
+    "O1": ["-O1"],
+    "O2": ["-O2"],
+    "O2-inline": ["-O2", "--inline"],
+    "aligned": ["--aligned"],
+    "compact": ["--compact"],
+}
+
 def load_test_case(file_path: str) -> Optional[TestCase]:
     try:
         with open(file_path, "rb") as f:
@@ -98,10 +111,114 @@ def save_test_case(file_path: str,
 @dataclass
 class RunStats:
     int_failed: int = 0
+    build_failed: int = 0
     ignored: int = 0
     failed_files: List[str] = field(default_factory=list)
 
-def run_test_for_file(file_path: str, stats: RunStats = RunStats()):
+def check_output(tc: TestCase, actual: subprocess.CompletedProcess) -> bool:
+    if actual.returncode == tc.returncode and actual.stdout == tc.stdout and actual.stderr == tc.stderr:
+        return True
+    print("[ERROR] Unexpected output")
+    print("  Expected:")
+    print("    return code: %s" % tc.returncode)
+    print("    stdout: \n%s" % tc.stdout.decode("utf-8"))
+    print("    stderr: \n%s" % tc.stderr.decode("utf-8"))
+    print("  Actual:")
+    print("    return code: %s" % actual.returncode)
+    print("    stdout: \n%s" % actual.stdout.decode("utf-8"))
+    print("    stderr: \n%s" % actual.stderr.decode("utf-8"))
+    return False
+
+@dataclass
+class VerifyTest:
+    patches: List[Tuple[int, bytes]] = field(default_factory=list)
+    truncate: Optional[int] = None
+
+# Verifier tests start with '//! verify'. Their plain build gets corrupted by the following
+# '//! patch : <code offset> : <hex bytes>' and '//! truncate : <code size>' lines and is run with '--verify'.
+def load_verify_test(file_path: str) -> Optional[VerifyTest]:
+    with open(file_path, "r") as f:
+        lines = [line.strip() for line in f if line.startswith("//!")]
+    if not lines or lines[0] != "//! verify":
+        return None
+    verify = VerifyTest()
+    for line in lines[1:]:
+        directive, *args = [arg.strip() for arg in line[len("//!"):].split(":")]
+        if directive == "patch":
+            verify.patches.append((int(args[0]), bytes.fromhex(args[1])))
+        elif directive == "truncate":
+            verify.truncate = int(args[0])
+        else:
+            assert False, "unknown directive '%s' in %s" % (directive, file_path)
+    return verify
+
+def corrupt_executable(exe_path: str, verify: VerifyTest):
+    with open(exe_path, "rb") as f:
+        exe = bytearray(f.read())
+    # Header (symbol count, code encoding), null-terminated name, code size, code, ...
+    size_pos = exe.index(b'\0', 16) + 1
+    code_pos = size_pos + 8
+    code_size = int.from_bytes(exe[size_pos:code_pos], "little")
+    for offset, patch in verify.patches:
+        assert offset + len(patch) <= code_size
+        exe[code_pos + offset:code_pos + offset + len(patch)] = patch
+    if verify.truncate is not None:
+        exe[size_pos:code_pos] = verify.truncate.to_bytes(8, "little")
+        del exe[code_pos + verify.truncate:code_pos + code_size]
+    with open(exe_path, "wb") as f:
+        f.write(exe)
+
+def run_verify_test(file_path: str, tc: TestCase, verify: VerifyTest, exe_path: str) -> subprocess.CompletedProcess:
+    build = build_test(file_path, [], exe_path)
+    if build.returncode != 0:
+        return build
+    corrupt_executable(exe_path, verify)
+    return cmd_run_echoed(["./mcd.sh", "Release", "--grantall", "--closeonexit", "--verify", exe_path, *tc.argv], input=tc.stdin, capture_output=True)
+
+def build_test(file_path: str, options: List[str], exe_path: str) -> subprocess.CompletedProcess:
+    return cmd_run_echoed(["./mcd.sh", "Release", "--build", "--nocache", "--closeonexit", *options, "-o", exe_path, file_path], capture_output=True)
+
+def build_and_run_test(file_path: str, tc: TestCase, options: List[str], exe_path: str) -> subprocess.CompletedProcess:
+    build = build_test(file_path, options, exe_path)
+    if build.returncode != 0:
+        # Assembler and linker errors are reported the same way as when interpreting.
+        return build
+    return cmd_run_echoed(["./mcd.sh", "Release", "--grantall", "--closeonexit", exe_path, *tc.argv], input=tc.stdin, capture_output=True)
+
+def build_test_case_path(file_path: str, name: str) -> str:
+    return file_path[:-len(".mca")] + ".%s.txt" % name
+
+def load_build_test_cases(file_path: str) -> Dict[str, TestCase]:
+    build_tcs = {}
+    for name in BUILD_OPTIONS:
+        build_tc = load_test_case(build_test_case_path(file_path, name))
+        if build_tc is not None:
+            build_tcs[name] = build_tc
+    return build_tcs
+
+def run_build_test(file_path: str, tc: TestCase, options: List[str], build_dir: str) -> bool:
+    exe_path = path.join(build_dir, path.basename(file_path)[:-len(".mca")] + ".mce")
+    if not check_output(tc, build_and_run_test(file_path, tc, options, exe_path)):
+        return False
+    if not path.isfile(exe_path):
+        return True
+
+    # Objects of unchanged modules (including the ones built by earlier tests) have to be reused instead of being written again.
+    objects = [entry.path for entry in os.scandir(build_dir) if entry.name.endswith(".mco")]
+    for obj_path in objects:
+        os.utime(obj_path, ns=(1, 1))
+    rebuild = build_test(file_path, options, exe_path)
+    rewritten = [obj_path for obj_path in objects if os.stat(obj_path).st_mtime_ns != 1]
+    if rebuild.returncode != 0 or rewritten:
+        print("[ERROR] Rebuilding without changes failed or reassembled: %s" % ", ".join(rewritten))
+        print(rebuild.stdout.decode("utf-8"))
+        return False
+
+    # Valid executables pass the verification and behave the same without the interpreter's runtime checks.
+    verified = cmd_run_echoed(["./mcd.sh", "Release", "--grantall", "--closeonexit", "--verify", exe_path, *tc.argv], input=tc.stdin, capture_output=True)
+    return check_output(tc, verified)
+
+def run_test_for_file(file_path: str, stats: RunStats = RunStats(), build_root: Optional[str] = None):
     assert path.isfile(file_path)
     assert file_path.endswith(".mca")
 
@@ -109,23 +226,33 @@ def run_test_for_file(file_path: str, stats: RunStats = RunStats()):
 
     tc_path = file_path[:-len(".mca")] + ".txt"
     tc = load_test_case(tc_path)
+    build_tcs = load_build_test_cases(file_path)
+    verify = load_verify_test(file_path)
 
     error = False
 
-    if tc is not None:
-        sim = cmd_run_echoed(["./mcd.sh", "Release", "--grantall", "--closeonexit", file_path, *tc.argv], input=tc.stdin, capture_output=True)
-        if sim.returncode != tc.returncode or sim.stdout != tc.stdout or sim.stderr != tc.stderr:
-            print("[ERROR] Unexpected output")
-            print("  Expected:")
-            print("    return code: %s" % tc.returncode)
-            print("    stdout: \n%s" % tc.stdout.decode("utf-8"))
-            print("    stderr: \n%s" % tc.stderr.decode("utf-8"))
-            print("  Actual:")
-            print("    return code: %s" % sim.returncode)
-            print("    stdout: \n%s" % sim.stdout.decode("utf-8"))
-            print("    stderr: \n%s" % sim.stderr.decode("utf-8"))
-            error = True
-            stats.int_failed += 1
+    if tc is not None and verify is not None:
+        with tempfile.TemporaryDirectory() as build_dir:
+            if not check_output(tc, run_verify_test(file_path, tc, verify, path.join(build_dir, "corrupted.mce"))):
+                error = True
+                stats.build_failed += 1
+    elif tc is not None or build_tcs:
+        if tc is not None:
+            sim = cmd_run_echoed(["./mcd.sh", "Release", "--grantall", "--closeonexit", file_path, *tc.argv], input=tc.stdin, capture_output=True)
+            if not check_output(tc, sim):
+                error = True
+                stats.int_failed += 1
+
+        with tempfile.TemporaryDirectory() as tmp_root:
+            for name, options in BUILD_OPTIONS.items():
+                build_tc = build_tcs.get(name, tc)
+                if build_tc is None:
+                    continue
+                build_dir = path.join(build_root or tmp_root, name)
+                os.makedirs(build_dir, exist_ok=True)
+                if not run_build_test(file_path, build_tc, options, build_dir):
+                    error = True
+                    stats.build_failed += 1
     else:
         print('[WARNING] No input/output data found for %s.' % file_path)
         error = True
@@ -137,12 +264,14 @@ def run_test_for_file(file_path: str, stats: RunStats = RunStats()):
 
 def run_test_for_folder(folder: str):
     stats = RunStats()
-    for entry in os.scandir(folder):
-        if entry.is_file() and entry.path.endswith(".mca"):
-            run_test_for_file(entry.path, stats)
+    # The tests share their build directories, objects of common modules get built once.
+    with tempfile.TemporaryDirectory() as build_root:
+        for entry in os.scandir(folder):
+            if entry.is_file() and entry.path.endswith(".mca"):
+                run_test_for_file(entry.path, stats, build_root)
     print()
-    print("Failed: %d, Ignored: %d" % (stats.int_failed, stats.ignored))
-    if stats.int_failed != 0:
+    print("Failed: %d, Build failed: %d, Ignored: %d" % (stats.int_failed, stats.build_failed, stats.ignored))
+    if stats.int_failed != 0 or stats.build_failed != 0:
         print("Failed files:")
         print()
         for failed_file in stats.failed_files:
@@ -165,7 +294,33 @@ def update_input_for_file(file_path: str, argv: List[str]):
 
 def update_output_for_file(file_path: str):
     tc_path = file_path[:-len(".mca")] + ".txt"
-    tc = load_test_case(tc_path) or DEFAULT_TEST_CASE
+    tc = load_test_case(tc_path)
+    build_tcs = load_build_test_cases(file_path)
+    verify = load_verify_test(file_path)
+
+    if verify is not None:
+        tc = tc or DEFAULT_TEST_CASE
+        with tempfile.TemporaryDirectory() as build_dir:
+            output = run_verify_test(file_path, tc, verify, path.join(build_dir, "corrupted.mce"))
+        print("[INFO] Saving output to %s" % tc_path)
+        save_test_case(tc_path,
+                       tc.argv, tc.stdin,
+                       output.returncode, output.stdout, output.stderr)
+        return
+
+    if tc is None and build_tcs:
+        # Tests limited to some option sets keep being limited to them.
+        with tempfile.TemporaryDirectory() as build_dir:
+            for name, build_tc in build_tcs.items():
+                build_tc_path = build_test_case_path(file_path, name)
+                build_output = build_and_run_test(file_path, build_tc, BUILD_OPTIONS[name], path.join(build_dir, name + ".mce"))
+                print("[INFO] Saving output to %s" % build_tc_path)
+                save_test_case(build_tc_path,
+                               build_tc.argv, build_tc.stdin,
+                               build_output.returncode, build_output.stdout, build_output.stderr)
+        return
+
+    tc = tc or DEFAULT_TEST_CASE
 
     output = cmd_run_echoed(["./mcd.sh", "Release", "--grantall", "--closeonexit", file_path, *tc.argv], input=tc.stdin, capture_output=True)
     print("[INFO] Saving output to %s" % tc_path)
@@ -173,6 +328,20 @@ def update_output_for_file(file_path: str):
                    tc.argv, tc.stdin,
                    output.returncode, output.stdout, output.stderr)
 
+    # Built executables only get their own output where it differs from the interpreted one.
+    with tempfile.TemporaryDirectory() as build_dir:
+        for name, options in BUILD_OPTIONS.items():
+            build_tc_path = build_test_case_path(file_path, name)
+            build_output = build_and_run_test(file_path, tc, options, path.join(build_dir, name + ".mce"))
+            if (build_output.returncode, build_output.stdout, build_output.stderr) == (output.returncode, output.stdout, output.stderr):
+                if path.isfile(build_tc_path):
+                    os.remove(build_tc_path)
+                continue
+            print("[INFO] Saving output to %s" % build_tc_path)
+            save_test_case(build_tc_path,
+                           tc.argv, tc.stdin,
+                           build_output.returncode, build_output.stdout, build_output.stderr)
+
 def update_output_for_folder(folder: str):
     for entry in os.scandir(folder):
         if entry.is_file() and entry.path.endswith(".mca"):